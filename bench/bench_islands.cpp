@@ -0,0 +1,149 @@
+/*
+ * File:    bench_islands.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: Time-to-target of the island-model LAHC (Islands.h): for
+ * 'runs' seeds, 'threads' islands that exchange their best tours on a
+ * ring every 'interval' iterations, against as many independent chains
+ * (migration `none`), each from a uniform random tour with the uniform
+ * 2-opt proposal and list size 'list_size'. The targets are 5%, 3% and
+ * 1.5% above 'optimum'; a monitor thread records the first wall time at
+ * which the best tour of the islands reached each of them, and stops the
+ * islands once they reached the last one, or after 'seconds'. One CSV
+ * line per (mode, run, target) is printed and written to 'csv_file',
+ * with -1 for a target that was not reached; sorted by time, they are
+ * the time-to-target curves. Usage:
+ *      bench_islands csv_file instance optimum [threads] [seconds] [runs]
+ *              [interval] [list_size]
+ * With more islands than cores, the islands share the cores, and the
+ * times mean little.
+ *
+ * Created on October 17, 2026
+ */
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <climits>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../src/TSPLIB.h"
+#include "../src/Islands.h"
+#include "../src/Util.h"
+
+using namespace std;
+
+#define SEED 7
+#define NUM_TARGETS 3
+#define MONITOR_MS 5 // between two looks of the monitor at the islands
+
+static const double target_gaps[NUM_TARGETS] = {0.05, 0.03, 0.015};
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+            start).count();
+}
+
+// runs the islands until the last target or 'seconds', and puts the time
+// each target was reached in 'times' (-1 if not)
+void run_case(TSPLIB &tsp, island_settings settings, long list_size,
+        const int *targets, double seconds, uint64_t seed,
+        vector<double> &times, long &iterations) {
+    stopping_criteria stopping;
+    // the islands stop on the target of their race (see Islands.h)
+    stopping.max_iteration = true;
+    stopping.max_iteration_par = LONG_MAX;
+    stopping.solution_quality = true;
+    stopping.solution_quality_par = targets[NUM_TARGETS - 1];
+    stopping.point_of_convergence = false;
+    stopping.list_convergence = false;
+    mutation_settings mutation;
+    mutation.proposal = UNIFORM_PROPOSAL;
+    mutation.policy = FIXED_POLICY;
+    mutation.num_neighbours = 8;
+    mutation.two_level_list = false;
+    mutation.batch_size = 1;
+    progress_settings progress;
+    progress.recorder = LOG_RECORDER;
+    progress.buckets = 8;
+
+    Islands islands(tsp, stopping, mutation, progress, list_size, settings,
+            seed);
+    times.assign(NUM_TARGETS, -1.);
+    std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+    std::thread runner(&Islands::run, &islands);
+    int reached = 0;
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(MONITOR_MS));
+        double now = seconds_since(start);
+        int best = islands.best_tour_size();
+        while (reached < NUM_TARGETS && best <= targets[reached])
+            times[reached++] = now;
+        if (reached == NUM_TARGETS || now >= seconds)
+            break;
+    }
+    islands.cancel();
+    runner.join();
+    iterations = islands.num_iterations();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        cout << "Usage: " << argv[0] << " csv_file instance optimum "
+                "[threads] [seconds] [runs] [interval] [list_size]" << endl;
+        return 1;
+    }
+    string csv_file = argv[1];
+    string instance = argv[2];
+    int optimum = atoi(argv[3]);
+    int threads = argc > 4 ? atoi(argv[4]) :
+            std::max(2u, std::thread::hardware_concurrency());
+    double seconds = argc > 5 ? atof(argv[5]) : 60.;
+    int runs = argc > 6 ? atoi(argv[6]) : 10;
+    long interval = argc > 7 ? atol(argv[7]) : 100000;
+    long list_size = argc > 8 ? atol(argv[8]) : 5000;
+    if (optimum <= 0 || threads < 2 || seconds <= 0 || runs < 1 ||
+            interval < 1 || list_size < 1)
+        error("bench_islands needs a positive optimum, seconds, runs, "
+            "interval and list_size, and at least 2 threads!");
+
+    TSPLIB tsp(instance);
+    int targets[NUM_TARGETS];
+    for (int t = 0; t < NUM_TARGETS; t++)
+        targets[t] = int(optimum * (1. + target_gaps[t]));
+
+    ofstream csv(csv_file.c_str());
+    string header = "instance,mode,islands,interval,run,gap,target,seconds,"
+            "iterations";
+    cout << header << endl;
+    csv << header << endl;
+    const migration_type modes[2] = {RING_MIGRATION, NO_MIGRATION};
+    const char *mode_names[2] = {"ring", "independent"};
+    for (int run = 0; run < runs; run++)
+        for (int mode = 0; mode < 2; mode++) {
+            island_settings settings;
+            settings.islands = threads;
+            settings.migration = modes[mode];
+            settings.interval = interval;
+            vector<double> times;
+            long iterations;
+            run_case(tsp, settings, list_size, targets, seconds,
+                    RandomStream::derive(SEED, run), times, iterations);
+            for (int t = 0; t < NUM_TARGETS; t++) {
+                char line[256];
+                snprintf(line, sizeof (line), "%s,%s,%d,%ld,%d,%.3f,%d,%.3f,"
+                        "%ld", tsp.properties.NAME.c_str(), mode_names[mode],
+                        threads, interval, run + 1, target_gaps[t],
+                        targets[t], times[t], iterations);
+                cout << line << endl;
+                csv << line << endl;
+            }
+        }
+    csv.close();
+    return 0;
+}
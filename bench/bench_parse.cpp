@@ -0,0 +1,141 @@
+/*
+ * File:    bench_parse.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: Compares the time to read the NODE_COORD_SECTION instances
+ * given on the command line with the current TSPLIB reader (mapped file,
+ * TextScanner) and with the previous one (getline, trim_string_blanks and
+ * sscanf per line, kept here as 'legacy_read'). Both readers must give
+ * bit-identical coordinates. Usage:
+ *      bench_parse instance.tsp [instance.tsp ...]
+ *
+ * Created on October 17, 2026
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <fstream>
+#include <string.h>
+#include <sys/stat.h>
+#include "../src/TSPLIB.h"
+#include "../src/Util.h"
+
+using namespace std;
+
+#define REPETITIONS 5
+
+typedef struct {
+    tsplib_properties properties;
+    std::vector<double> x;
+    std::vector<double> y;
+} legacy_instance;
+
+// the reader of TSPLIB before the TextScanner, for NODE_COORD_SECTION only
+void legacy_read(string file, legacy_instance &instance) {
+    std::ifstream in(file);
+    if (in.good() != 1)
+        error("Couldn't open " + file + "!");
+    tsplib_properties &properties = instance.properties;
+    properties.DIMENSION = 0;
+    string line, key, value;
+    while (!in.eof() && properties.FORMAT == "") {
+        getline(in, line);
+        trim_string_blanks(line);
+        if (line.empty() || line[0] == '#')
+            continue;
+        if (line == "NODE_COORD_SECTION" or line == "EDGE_WEIGHT_SECTION") {
+            properties.FORMAT = line;
+            break;
+        }
+        size_t firstColomn = line.find_first_of(":");
+        if (firstColomn >= line.size())
+            error("missing colomn in " + file + "!");
+        key = line.substr(0, firstColomn);
+        value = line.substr(firstColomn + 1, line.size());
+        trim_string_blanks(key);
+        trim_string_blanks(value);
+        if (key == "NAME")
+            properties.NAME = value;
+        else if (key == "DIMENSION")
+            properties.DIMENSION = atoi(value.c_str());
+        else if (key == "EDGE_WEIGHT_TYPE")
+            properties.EDGE_WEIGHT_TYPE = value;
+    }
+    if (properties.FORMAT != "NODE_COORD_SECTION")
+        error(file + " has no NODE_COORD_SECTION!");
+    instance.x.assign(properties.DIMENSION, 0.);
+    instance.y.assign(properties.DIMENSION, 0.);
+    double x, y;
+    int k;
+    while (!in.eof()) {
+        getline(in, line);
+        trim_string_blanks(line);
+        if (!line.empty() && line != "EOF") {
+            sscanf(line.c_str(), "%d %lf %lf", &k, &x, &y);
+            instance.x[k - 1] = x;
+            instance.y[k - 1] = y;
+        }
+    }
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+            start).count();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cout << "Usage: " << argv[0] << " instance.tsp [instance.tsp ...]"
+                << endl;
+        exit(1);
+    }
+    cout << std::left << std::setw(24) << "instance" << std::right
+            << std::setw(10) << "cities" << std::setw(10) << "MB"
+            << std::setw(14) << "legacy_ms" << std::setw(14) << "scanner_ms"
+            << std::setw(10) << "speedup" << endl;
+    for (int f = 1; f < argc; f++) {
+        string file = argv[f];
+        struct stat file_status;
+        if (stat(file.c_str(), &file_status) != 0)
+            error("Couldn't open " + file + "!");
+        double legacy_best = 1e30, scanner_best = 1e30;
+        legacy_instance legacy;
+        int dimension = 0;
+        bool identical = true;
+        // best of REPETITIONS, so both readers see a warm page cache
+        for (int r = 0; r < REPETITIONS; r++) {
+            legacy = legacy_instance();
+            std::chrono::steady_clock::time_point start =
+                    std::chrono::steady_clock::now();
+            legacy_read(file, legacy);
+            legacy_best = std::min(legacy_best, seconds_since(start));
+
+            start = std::chrono::steady_clock::now();
+            TSPLIB tsp_instance(file, "coordinates");
+            scanner_best = std::min(scanner_best, seconds_since(start));
+            dimension = tsp_instance.properties.DIMENSION;
+            identical = identical && dimension ==
+                    legacy.properties.DIMENSION &&
+                    tsp_instance.properties.NAME == legacy.properties.NAME &&
+                    memcmp(tsp_instance.cities_x, legacy.x.data(),
+                    sizeof (double) * dimension) == 0 &&
+                    memcmp(tsp_instance.cities_y, legacy.y.data(),
+                    sizeof (double) * dimension) == 0;
+        }
+        string name = file.substr(file.find_last_of('/') + 1);
+        cout << std::left << std::setw(24) << name << std::right
+                << std::setw(10) << dimension << std::setw(10)
+                << std::fixed << std::setprecision(2)
+                << file_status.st_size / (1024. * 1024.)
+                << std::setw(14) << std::setprecision(3)
+                << 1000 * legacy_best << std::setw(14)
+                << 1000 * scanner_best << std::setw(10)
+                << std::setprecision(1) << legacy_best / scanner_best
+                << (identical ? "" : "  COORDINATES DIFFER") << endl;
+        if (!identical)
+            return 1;
+    }
+    return 0;
+}
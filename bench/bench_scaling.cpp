@@ -0,0 +1,237 @@
+/*
+ * File:    bench_scaling.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: Measures how the run time and memory of LAHC and pLAHC scale
+ * with the number of cities and with their spatial structure. It generates
+ * EUC_2D instances of three kinds:
+ *      - uniform:   cities uniformly spread over a square,
+ *      - clustered: cities in dense Gaussian clusters (like the 'fl'
+ *                   instances of TSPLIB),
+ *      - grid:      a rattled grid (like the 'rat' instances of TSPLIB),
+ * for 1k, 10k, 100k and 1M cities (up to 'max_cities'). The instances are
+ * written once as .tsp files in 'instance_dir' and are then read through
+ * TSPLIB, so the load time includes the real reader and the distance
+ * backend that 'auto' picks.
+ * Every (instance, algorithm) case runs in its own child process, so that
+ * its peak RSS is not hidden by an earlier, larger case. The child loads the
+ * instance and runs 'iterations' iterations of LAHC (list size 1000) or of
+ * pLAHC (base list size 1, scaling 2, point of convergence 2%) from a
+ * uniform random tour with the uniform 2-opt proposal. One CSV line per
+ * case is printed and written to 'csv_file'. Usage:
+ *      bench_scaling csv_file [max_cities] [iterations] [instance_dir]
+ * The side of the square shrinks with the number of cities, so the length
+ * of the random start tour (an 'int') does not overflow.
+ *
+ * Created on October 17, 2026
+ */
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "../src/TSPLIB.h"
+#include "../src/LAHC.h"
+#include "../src/pLAHC.h"
+#include "../src/Util.h"
+#include "../src/Random.h"
+
+using namespace std;
+
+#define SEED 7
+#define LAHC_LIST_SIZE 1000
+#define CITIES_PER_CLUSTER 200
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+            start).count();
+}
+
+double square_side(int n) {
+    // the random start tour is about 0.52 * side * n long
+    return std::min(1000000., 2e9 / n);
+}
+
+void generate_cities(string structure, int n, vector<double> &x,
+        vector<double> &y) {
+    Random random;
+    random.randomize(1. / (SEED + n));
+    double side = square_side(n);
+    x.resize(n);
+    y.resize(n);
+    if (structure == "uniform") {
+        for (int i = 0; i < n; i++) {
+            x[i] = random.uniform(0., side);
+            y[i] = random.uniform(0., side);
+        }
+    } else if (structure == "clustered") {
+        int num_clusters = std::max(1, n / CITIES_PER_CLUSTER);
+        // a cluster covers about 1% of the area of its share of the square
+        double spread = 0.1 * side / sqrt((double) num_clusters);
+        vector<double> centre_x(num_clusters), centre_y(num_clusters);
+        for (int c = 0; c < num_clusters; c++) {
+            centre_x[c] = random.uniform(0., side);
+            centre_y[c] = random.uniform(0., side);
+        }
+        for (int i = 0; i < n; i++) {
+            int c = random.uniform(0L, (long) num_clusters - 1);
+            x[i] = std::min(side, std::max(0., random.normal_stddev(
+                    centre_x[c], spread)));
+            y[i] = std::min(side, std::max(0., random.normal_stddev(
+                    centre_y[c], spread)));
+        }
+    } else if (structure == "grid") {
+        int columns = (int) ceil(sqrt((double) n));
+        double spacing = side / columns;
+        for (int i = 0; i < n; i++) {
+            x[i] = spacing * (i % columns + random.uniform(-0.3, 0.3));
+            y[i] = spacing * (i / columns + random.uniform(-0.3, 0.3));
+        }
+    } else
+        error("Unknown structure `" + structure + "`!");
+}
+
+string instance_file(string dir, string structure, int n) {
+    string file = dir + "/" + structure + std::to_string(n) + ".tsp";
+    struct stat file_status;
+    if (stat(file.c_str(), &file_status) == 0)
+        return file;
+    vector<double> x, y;
+    generate_cities(structure, n, x, y);
+    string tmp = file + ".tmp";
+    FILE *out = fopen(tmp.c_str(), "w");
+    if (out == NULL)
+        error("Couldn't write " + tmp + "!");
+    fprintf(out, "NAME : %s%d\nCOMMENT : %s instance of bench_scaling\n"
+            "TYPE : TSP\nDIMENSION : %d\nEDGE_WEIGHT_TYPE : EUC_2D\n"
+            "NODE_COORD_SECTION\n", structure.c_str(), n, structure.c_str(),
+            n);
+    for (int i = 0; i < n; i++)
+        fprintf(out, "%d %.2f %.2f\n", i + 1, x[i], y[i]);
+    fprintf(out, "EOF\n");
+    if (fclose(out) != 0 || rename(tmp.c_str(), file.c_str()) != 0)
+        error("Couldn't write " + file + "!");
+    return file;
+}
+
+// runs in the child: load the instance, run the algorithm, and write
+// "load_seconds run_seconds iterations best_length backend" to 'out'
+void run_case(string file, string algorithm, long iterations, FILE *out) {
+    std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+    TSPLIB tsp_instance(file);
+    double load_seconds = seconds_since(start);
+
+    stopping_criteria stopping;
+    stopping.max_iteration = true;
+    stopping.max_iteration_par = iterations;
+    stopping.solution_quality = false;
+    stopping.point_of_convergence = algorithm == "pLAHC";
+    stopping.point_of_convergence_par = 100. / 2;
+    stopping.list_convergence = false;
+    mutation_settings mutation;
+    mutation.proposal = UNIFORM_PROPOSAL;
+    mutation.policy = FIXED_POLICY;
+    mutation.num_neighbours = 8;
+    mutation.two_level_list = false;
+    mutation.batch_size = 1;
+    progress_settings progress;
+    progress.recorder = ALL_RECORDER;
+
+    long done;
+    int best;
+    start = std::chrono::steady_clock::now();
+    if (algorithm == "LAHC") {
+        LAHC lahc(tsp_instance, stopping, mutation, progress, LAHC_LIST_SIZE,
+                SEED);
+        lahc.run();
+        done = lahc.num_iterations();
+        best = lahc.best_tour_size();
+    } else {
+        pLAHC plahc(tsp_instance, stopping, mutation, progress, 1, 2, SEED);
+        plahc.run();
+        done = plahc.num_iterations();
+        best = plahc.best_tour_size();
+    }
+    double run_seconds = seconds_since(start);
+    string backend = tsp_instance.distance_matrix.describe();
+    backend = backend.substr(0, backend.find(','));
+    fprintf(out, "%.6f %.6f %ld %d %s\n", load_seconds, run_seconds, done,
+            best, backend.c_str());
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cout << "Usage: " << argv[0] << " csv_file [max_cities] [iterations] "
+                "[instance_dir]" << endl;
+        exit(1);
+    }
+    string csv_file = argv[1];
+    long max_cities = argc > 2 ? atol(argv[2]) : 1000000;
+    long iterations = argc > 3 ? atol(argv[3]) : 200000;
+    string dir = argc > 4 ? argv[4] : "bench/instances";
+    mkdir(dir.c_str(), 0777);
+
+    const char *structures[] = {"uniform", "clustered", "grid"};
+    const char *algorithms[] = {"LAHC", "pLAHC"};
+    ofstream csv(csv_file.c_str());
+    string header = "structure,cities,algorithm,distance_backend,load_s,"
+            "iterations,iterations_per_s,peak_rss_mb,best_length";
+    csv << header << endl;
+    cout << header << endl;
+    for (long n = 1000; n <= max_cities; n *= 10)
+        for (int s = 0; s < 3; s++) {
+            string file = instance_file(dir, structures[s], n);
+            for (int a = 0; a < 2; a++) {
+                fflush(stdout);
+                int channel[2];
+                if (pipe(channel) != 0)
+                    error("pipe() failed!");
+                pid_t child = fork();
+                if (child < 0)
+                    error("fork() failed!");
+                if (child == 0) {
+                    close(channel[0]);
+                    FILE *out = fdopen(channel[1], "w");
+                    run_case(file, algorithms[a], iterations, out);
+                    fclose(out);
+                    _exit(0);
+                }
+                close(channel[1]);
+                FILE *in = fdopen(channel[0], "r");
+                double load_seconds = 0, run_seconds = 0;
+                long done = 0;
+                int best = 0;
+                char backend[64] = "";
+                int fields = fscanf(in, "%lf %lf %ld %d %63[^\n]",
+                        &load_seconds, &run_seconds, &done, &best, backend);
+                fclose(in);
+                int status;
+                struct rusage usage;
+                wait4(child, &status, 0, &usage);
+                if (fields != 5 || !WIFEXITED(status) ||
+                        WEXITSTATUS(status) != 0)
+                    error(string("The ") + algorithms[a] + " case of " +
+                        file + " failed!");
+                std::ostringstream line;
+                line << structures[s] << "," << n << "," << algorithms[a] <<
+                        "," << backend << "," << load_seconds << "," <<
+                        done << "," << (long) (done / run_seconds) << "," <<
+                        usage.ru_maxrss / 1024. << "," << best;
+                csv << line.str() << endl;
+                cout << line.str() << endl;
+            }
+        }
+    csv.close();
+    return 0;
+}
@@ -0,0 +1,169 @@
+/*
+ * File:    bench_two_level.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: Finds the number of cities from which a 2-opt move is
+ * cheaper on a TwoLevelList than on the plain tour array. For each size, the
+ * same number of random 2-opt moves is applied to a random tour:
+ *      - array:     two uniform random cuts, and 'reverse_segment' of the
+ *                   cities between them (what LAHC does by default),
+ *      - two_level: two uniform random cities, and 'TwoLevelList::flip'.
+ * Both include drawing the move. Before timing, the two representations are
+ * checked against each other: after every one of a few thousand moves,
+ * both must hold the same cycle, and 'between' must agree with the array.
+ * A tour saved half way, or two moves before the end ('save'), must come
+ * back from 'saved_tour'.
+ * Usage:
+ *      bench_two_level [max_cities] [moves]
+ *
+ * Created on October 17, 2026
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <stdlib.h>
+#include "../src/TwoLevelList.h"
+#include "../src/TSP_mutation.h"
+#include "../src/Util.h"
+#include "../src/RandomStream.h"
+
+using namespace std;
+RandomStream stream(5); // the tours and the moves
+
+#define CHECK_MOVES 3000
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+            start).count();
+}
+
+// true if 'a' and 'b' are the same cycle, in one direction or the other
+bool same_cycle(const std::vector<int> &a, const std::vector<int> &b) {
+    int n = a.size();
+    std::vector<int> following(n), preceding(n);
+    for (int k = 0; k < n; k++) {
+        following[a[k]] = a[(k + 1) % n];
+        preceding[a[k]] = a[(k + n - 1) % n];
+    }
+    bool forward = true, backward = true;
+    for (int k = 0; k < n; k++) {
+        forward = forward && following[b[k]] == b[(k + 1) % n];
+        backward = backward && preceding[b[k]] == b[(k + 1) % n];
+    }
+    return forward || backward;
+}
+
+// applies random moves to both representations and compares them
+bool check(int n, int moves, int save_at) {
+    std::vector<int> tour(n), position(n), cycle(n), saved;
+    makeshuffle(n, tour.data(), n, stream);
+    TwoLevelList list;
+    list.init(n, tour.data());
+    for (int i = 0; i < n; i++)
+        position[tour[i]] = i;
+    for (int m = 0; m < moves; m++) {
+        if (m == save_at) {
+            list.save();
+            saved = tour;
+        }
+        int a = stream.below(n);
+        int c = stream.below(n);
+        int b = list.next(a), d = list.next(c);
+        list.flip(a, b, c, d);
+        // the same move on the array: the path between the two edges that
+        // does not wrap around the end of the array is reversed
+        int i = position[a], j = position[c];
+        // 1 if the array and the list run the same way round
+        int shift = tour[(i + 1) % n] == b;
+        int from = std::min(i, j) + shift, to = std::max(i, j) + shift;
+        std::reverse(tour.begin() + from, tour.begin() + to);
+        for (int k = from; k < to; k++)
+            position[tour[k]] = k;
+        // same cycle, in one direction or the other
+        bool forward = list.next(tour[0]) == tour[1];
+        for (int k = 0; k < n; k++) {
+            int following = tour[forward ? (k + 1) % n : (k + n - 1) % n];
+            if (list.next(tour[k]) != following ||
+                    list.prev(following) != tour[k])
+                return false;
+        }
+        int x = tour[stream.below(n)];
+        int y = tour[stream.below(n)];
+        int z = tour[stream.below(n)];
+        int px = position[x], py = position[y], pz = position[z];
+        if (!forward) {
+            px = n - 1 - px;
+            py = n - 1 - py;
+            pz = n - 1 - pz;
+        }
+        bool expected = (py - px + n) % n <= (pz - px + n) % n;
+        if (list.between(x, y, z) != expected)
+            return false;
+    }
+    list.to_array(cycle.data());
+    if (!same_cycle(tour, cycle))
+        return false;
+    list.saved_tour(cycle.data());
+    return same_cycle(saved, cycle);
+}
+
+int main(int argc, char** argv) {
+    long max_cities = argc > 1 ? atol(argv[1]) : 200000;
+    int moves = argc > 2 ? atoi(argv[2]) : 50000;
+    int check_sizes[] = {10, 97, 1000, 10007};
+    for (int s = 0; s < 4; s++)
+        if (!check(check_sizes[s], CHECK_MOVES, CHECK_MOVES / 2) ||
+                !check(check_sizes[s], CHECK_MOVES, CHECK_MOVES - 2)) {
+            cout << "TwoLevelList differs from the array for " <<
+                    check_sizes[s] << " cities" << endl;
+            return 1;
+        }
+    cout << "TwoLevelList checked against the array" << endl;
+
+    int sizes[] = {500, 1000, 2000, 3000, 5000, 10000, 20000, 50000, 100000,
+        200000, 500000, 1000000};
+    cout << std::setw(10) << "cities" << std::setw(12) << "array_ns" <<
+            std::setw(14) << "two_level_ns" << std::setw(10) << "speedup" <<
+            std::setw(10) << "rebuilds" << endl;
+    for (int s = 0; s < 12 && sizes[s] <= max_cities; s++) {
+        int n = sizes[s];
+        std::vector<int> tour(n);
+        makeshuffle(n, tour.data(), n, stream);
+        TwoLevelList list;
+        list.init(n, tour.data());
+
+        tsp_mut_properties mut_conf;
+        int cuts[3];
+        mut_conf.cuts = cuts;
+        mut_conf.position = NULL;
+        mut_conf.random = &stream;
+        mut_conf.cut_pairs = NULL;
+        std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+        for (int m = 0; m < moves; m++) {
+            pick_k_without_replacement(2, n, cuts, stream);
+            if (cuts[0] > cuts[1])
+                std::swap(cuts[0], cuts[1]);
+            reverse_segment(tour.data(), &mut_conf);
+        }
+        double array_seconds = seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int m = 0; m < moves; m++) {
+            int a = stream.below(n);
+            int c = stream.below(n);
+            list.flip(a, list.next(a), c, list.next(c));
+        }
+        double list_seconds = seconds_since(start);
+        cout << std::setw(10) << n << std::fixed << std::setprecision(1) <<
+                std::setw(12) << 1e9 * array_seconds / moves <<
+                std::setw(14) << 1e9 * list_seconds / moves <<
+                std::setw(10) << std::setprecision(2) <<
+                array_seconds / list_seconds << std::setw(10) <<
+                list.num_rebuilds() << endl;
+    }
+    return 0;
+}
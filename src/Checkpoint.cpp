@@ -0,0 +1,125 @@
+/*
+ * File:    Checkpoint.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: Binary checkpoints of a whole experiment.
+ *
+ */
+
+#include "Checkpoint.h"
+#include <stdio.h>
+#include <unistd.h>
+
+using namespace std;
+
+bool CheckpointIn::open(string path) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == NULL)
+        return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    bytes.resize(size);
+    if (size > 0 && fread(bytes.data(), 1, size, file) != (size_t) size)
+        error("Could not read the checkpoint file `" + path + "`!");
+    fclose(file);
+    position = 0;
+    return true;
+}
+
+Checkpoint::Checkpoint(string checkpoint_file, double checkpoint_seconds,
+        uint64_t experiment_fingerprint) {
+    file = checkpoint_file;
+    seconds = checkpoint_seconds;
+    fingerprint = experiment_fingerprint;
+    resumed = false;
+    next = enabled() ? std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(seconds)) :
+            std::chrono::steady_clock::time_point::max();
+}
+
+Checkpoint::~Checkpoint() {
+    if (writer.joinable())
+        writer.join();
+}
+
+bool Checkpoint::enabled() const {
+    return seconds > 0;
+}
+
+void Checkpoint::set_state(std::function<void(CheckpointOut &)> state) {
+    save_state = state;
+}
+
+// writes 'bytes' to 'file' through a temporary file, so that 'file' is
+// always whole
+static void write_file(string file, std::vector<char> *bytes) {
+    string temporary = file + ".tmp";
+    FILE *out = fopen(temporary.c_str(), "wb");
+    bool written = out != NULL && fwrite(bytes->data(), 1, bytes->size(),
+            out) == bytes->size() && fflush(out) == 0 &&
+            fsync(fileno(out)) == 0;
+    if (out != NULL)
+        fclose(out);
+    if (written)
+        rename(temporary.c_str(), file.c_str());
+    else
+        cerr << "Could not write the checkpoint file `" << file << "`" << endl;
+    delete bytes;
+}
+
+void Checkpoint::write() {
+    if (!enabled())
+        return;
+    CheckpointOut out;
+    out.put((uint64_t) CHECKPOINT_MAGIC);
+    out.put((uint32_t) CHECKPOINT_VERSION);
+    out.put(fingerprint);
+    save_state(out);
+    if (writer.joinable())
+        writer.join();
+    writer = std::thread(write_file, file,
+            new std::vector<char>(std::move(out.bytes)));
+    next = std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(seconds));
+}
+
+void Checkpoint::finish() {
+    if (writer.joinable())
+        writer.join();
+    if (enabled() || resumed)
+        remove(file.c_str());
+}
+
+bool Checkpoint::resume(CheckpointIn &in) {
+    if (!in.open(file))
+        return false;
+    uint64_t magic, experiment;
+    uint32_t version;
+    in.get(magic);
+    in.get(version);
+    in.get(experiment);
+    if (magic != CHECKPOINT_MAGIC)
+        error("`" + file + "` is not a checkpoint file!");
+    if (version != CHECKPOINT_VERSION)
+        error("Unsupported checkpoint version " + std::to_string(version) +
+            " in `" + file + "`!");
+    if (experiment != fingerprint)
+        error("The checkpoint `" + file + "` was written with other "
+            "parameters!");
+    resumed = true;
+    return true;
+}
+
+uint64_t Checkpoint::fingerprint_of(string text) {
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < text.size(); i++) {
+        hash ^= (unsigned char) text[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
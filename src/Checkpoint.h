@@ -0,0 +1,136 @@
+/*
+ * File:    Checkpoint.h
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: Binary checkpoints of a whole experiment, for `checkpoint`
+ * and `resume`.
+ * The state is written into a CheckpointOut by the function given to
+ * 'set_state' (main writes its runs, and the running algorithm its lists),
+ * and read back in the same order from a CheckpointIn. The values are
+ * copied as they are in memory, so a checkpoint is only read on a machine
+ * like the one that wrote it, by the same build.
+ * 'write' makes the buffer on the calling thread, and a writer thread puts
+ * it in <file>.tmp, syncs it, and renames it over <file>, so the file is
+ * always a whole checkpoint. The run goes on while the file is written; a
+ * new 'write' waits for the former one only if it is not done yet.
+ * The loop of LAHC looks at the clock every CHECKPOINT_POLL iterations
+ * ('due'), so a run without checkpoints pays one comparison per iteration.
+ * A checkpoint starts with CHECKPOINT_MAGIC, CHECKPOINT_VERSION and the
+ * fingerprint of the parameters of the experiment, so that a run is not
+ * resumed with other parameters.
+ *
+ * Created on October 17, 2026
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "Util.h"
+#include <stdint.h>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+#define CHECKPOINT_MAGIC 0x31544b4348414c50ULL // "PLAHCKT1"
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_POLL 65536 // iterations between two looks at the clock
+
+class CheckpointOut {
+public:
+    std::vector<char> bytes;
+
+    template <class T> void put(const T &value) {
+        put_array(&value, 1);
+    }
+
+    template <class T> void put_array(const T *values, size_t n) {
+        const char *first = (const char *) values;
+        bytes.insert(bytes.end(), first, first + n * sizeof(T));
+    }
+
+    template <class T> void put_vector(const std::vector<T> &values) {
+        put((uint64_t) values.size());
+        put_array(values.data(), values.size());
+    }
+
+    // an array of 'n' values that may have been freed (NULL)
+    template <class T> void put_buffer(const T *values, size_t n) {
+        put(values != NULL);
+        if (values != NULL)
+            put_array(values, n);
+    }
+};
+
+class CheckpointIn {
+public:
+    bool open(string path);
+
+    template <class T> void get(T &value) {
+        get_array(&value, 1);
+    }
+
+    template <class T> void get_array(T *values, size_t n) {
+        if (n * sizeof(T) > bytes.size() - position)
+            error("The checkpoint file is truncated!");
+        char *first = (char *) values;
+        std::copy(bytes.begin() + position,
+                bytes.begin() + position + n * sizeof(T), first);
+        position += n * sizeof(T);
+    }
+
+    template <class T> void get_vector(std::vector<T> &values) {
+        uint64_t size;
+        get(size);
+        values.resize(size);
+        get_array(values.data(), size);
+    }
+
+    // the array written by 'put_buffer', new[]-allocated, or NULL
+    template <class T> T *get_buffer(size_t n) {
+        bool present;
+        get(present);
+        if (!present)
+            return NULL;
+        T *values = new T[n];
+        get_array(values, n);
+        return values;
+    }
+
+private:
+    std::vector<char> bytes;
+    size_t position;
+};
+
+class Checkpoint {
+public:
+    Checkpoint(string file, double seconds, uint64_t fingerprint);
+    ~Checkpoint();
+    bool enabled() const;
+    void set_state(std::function<void(CheckpointOut &)> state);
+    void write();
+    void finish(); // waits for the last write, and removes the file
+    bool resume(CheckpointIn &in); // false if there is no file
+
+    // it is time for a new checkpoint
+    inline bool due() const {
+        return std::chrono::steady_clock::now() >= next;
+    }
+
+    static uint64_t fingerprint_of(string text);
+
+private:
+    string file;
+    double seconds; // between two checkpoints, 0 for none
+    uint64_t fingerprint;
+    bool resumed; // from the file, which is removed at the end
+    std::function<void(CheckpointOut &)> save_state;
+    std::chrono::steady_clock::time_point next; // of the next checkpoint
+    std::thread writer;
+};
+
+#endif /* CHECKPOINT_H */
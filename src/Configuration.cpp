@@ -8,14 +8,62 @@
  */
 
 #include "Configuration.h"
+#include "TSP_mutation.h"
 
 using namespace std;
 
+#define NUM_PROPOSALS 4
+
+// the values of `proposal`, in the order of 'proposal_type'
+static const char *proposal_names[NUM_PROPOSALS] = {"uniform", "neighbour",
+    "or_opt", "mixed"};
+
+#define NUM_POLICIES 3
+
+// the values of `mutation_policy`, in the order of 'mutation_policy_type'
+static const char *policy_names[NUM_POLICIES] = {"fixed", "random", "bandit"};
+
+#define NUM_RECORDERS 3
+
+// the values of `progress_recorder`, in the order of 'recorder_type'
+static const char *recorder_names[NUM_RECORDERS] = {"all", "log",
+    "reservoir"};
+
+#define NUM_MIGRATIONS 3
+
+// the values of `migration`, in the order of 'migration_type'
+static const char *migration_names[NUM_MIGRATIONS] = {"none", "ring",
+    "broadcast"};
+
 Configuration::Configuration(string input) {
     inputfile = input;
     std::ifstream in(inputfile);
     stopping.solution_quality = stopping.max_iteration =
-            stopping.point_of_convergence = false;
+            stopping.point_of_convergence = stopping.list_convergence = false;
+    distance_backend = "auto";
+    distance_cache_mb = 256;
+    renumbering = "none";
+    restore_best_tour = "off";
+    list_size = 0;
+    base_list_size = 1;
+    list_scaling_size = 2;
+    mutation.proposal = UNIFORM_PROPOSAL;
+    mutation.policy = FIXED_POLICY;
+    mutation.num_neighbours = 8;
+    mutation.two_level_list = false;
+    mutation.batch_size = 1;
+    history_capacity = 0;
+    race_threads = 1;
+    island.islands = 1;
+    island.migration = RING_MIGRATION;
+    island.interval = 100000;
+    progress.recorder = ALL_RECORDER;
+    progress.buckets = 16;
+    progress.capacity = 4096;
+    threads = 1;
+    pin_threads = "off";
+    checkpoint_seconds = 0;
+    resume = "off";
     read_inputfile(in);
     in.close();
 }
@@ -63,15 +111,58 @@ void Configuration::read_inputfile(ifstream &in) {
         if (stopping.point_of_convergence == true)
             output = output + "_poc" +
                 to_string(int(stopping.point_of_convergence_par));
+        if (stopping.list_convergence == true)
+            output = output + "_lc" + to_string(stopping.list_convergence_par);
     }
 
-    // remove log, progress, and avg files, if they exist.
-    string file_name = output + ".log";
-    remove(file_name.c_str());
-    file_name = output + ".progress";
-    remove(file_name.c_str());
-    file_name = output + ".avg";
-    remove(file_name.c_str());
+    if (stopping.list_convergence && stopping.point_of_convergence)
+        error("stopping_criterion `list_convergence` and "
+            "`point_of_convergence` cannot be used together!");
+    if (mutation.two_level_list && mutation.proposal != UNIFORM_PROPOSAL &&
+            mutation.proposal != NEIGHBOUR_PROPOSAL)
+        error("tour_representation `two_level` only works with the "
+            "`uniform` and `neighbour` proposals!");
+    if (mutation.batch_size > 1 && (mutation.proposal != UNIFORM_PROPOSAL ||
+            mutation.two_level_list))
+        error("batch_size only works with the `uniform` proposal and "
+            "tour_representation `array`!");
+    if (mutation.policy != FIXED_POLICY && (mutation.proposal !=
+            UNIFORM_PROPOSAL || mutation.two_level_list ||
+            mutation.batch_size > 1))
+        error("mutation_policy `random` and `bandit` only work with the "
+            "`uniform` proposal, tour_representation `array` and "
+            "batch_size 1!");
+    if ((checkpoint_seconds > 0 || resume == "on") &&
+            (mutation.two_level_list || mutation.batch_size > 1))
+        error("checkpoint and resume do not work with tour_representation "
+            "`two_level` or batch_size more than 1!");
+    if ((checkpoint_seconds > 0 || resume == "on") && (threads != 1 ||
+            race_threads != 1))
+        error("checkpoint and resume only work with threads 1 and "
+            "race_threads 1!");
+    if (race_threads != 1 && algorithm != "pLAHC")
+        error("race_threads only works with the `pLAHC` algorithm!");
+    if (race_threads != 1 && !stopping.solution_quality &&
+            !stopping.max_iteration)
+        error("race_threads needs the `solution_quality` or `max_iteration` "
+            "stopping_criterion!");
+    if (island.islands > 1 && (algorithm != "LAHC" ||
+            mutation.two_level_list || mutation.batch_size > 1 ||
+            checkpoint_seconds > 0 || resume == "on"))
+        error("islands only work with the `LAHC` algorithm, "
+            "tour_representation `array` and batch_size 1, without "
+            "checkpoint and resume!");
+
+    // remove log, progress, and avg files, if they exist, unless the
+    // experiment goes on from its checkpoint
+    if (resume != "on" || !ifstream((output + ".ckpt").c_str()).good()) {
+        string file_name = output + ".log";
+        remove(file_name.c_str());
+        file_name = output + ".progress";
+        remove(file_name.c_str());
+        file_name = output + ".avg";
+        remove(file_name.c_str());
+    }
 
     // update the stopping criterion parameter
     if (stopping.point_of_convergence == true)
@@ -84,28 +175,89 @@ void Configuration::set_parameter(string& key, string& value) {
         inputfile = value;
     } else if (key == "problem_name") {
         problem_name = value;
+    } else if (key == "distance_backend") {
+        distance_backend = value;
+    } else if (key == "distance_cache_mb") {
+        distance_cache_mb = atoi(value.c_str());
+        if (distance_cache_mb < 1)
+            error("distance_cache_mb should be at least 1!");
+    } else if (key == "renumbering") {
+        renumbering = value;
+        if (renumbering != "none" && renumbering != "hilbert")
+            error("renumbering should be `none` or `hilbert`!");
     } else if (key == "algorithm") {
         algorithm = value;
     } else if (key == "seed") {
         seed = atoi(value.c_str());
     } else if (key == "number_run") {
         num_run = atoi(value.c_str());
+    } else if (key == "threads") {
+        threads = atoi(value.c_str());
+        if (threads < 0)
+            error("threads should be 0 (one per core) or more!");
+    } else if (key == "pin_threads") {
+        pin_threads = value;
+        if (pin_threads != "on" && pin_threads != "off")
+            error("pin_threads should be `on` or `off`!");
     } else if (key == "list_size") {
         list_size = atoi(value.c_str());
+    } else if (key == "islands") {
+        island.islands = atoi(value.c_str());
+        if (island.islands < 1)
+            error("islands should be at least 1!");
+    } else if (key == "migration") {
+        set_migration_parameter(value);
+    } else if (key == "proposal") {
+        set_proposal_parameter(value);
+    } else if (key == "mutation_policy") {
+        set_mutation_policy_parameter(value);
+    } else if (key == "num_neighbours") {
+        mutation.num_neighbours = atoi(value.c_str());
+        if (mutation.num_neighbours < 1)
+            error("num_neighbours should be at least 1!");
+    } else if (key == "tour_representation") {
+        if (value != "array" && value != "two_level")
+            error("tour_representation should be `array` or `two_level`!");
+        mutation.two_level_list = value == "two_level";
+    } else if (key == "batch_size") {
+        mutation.batch_size = atoi(value.c_str());
+        if (mutation.batch_size < 1 || mutation.batch_size > MAX_MOVE_BATCH)
+            error("batch_size should be between 1 and " +
+                std::to_string(MAX_MOVE_BATCH) + "!");
     } else if (key == "base_list_size") {
         base_list_size = atoi(value.c_str());
     } else if (key == "list_scaling_size") {
         list_scaling_size = atoi(value.c_str());
+    } else if (key == "history_capacity") {
+        history_capacity = atoi(value.c_str());
+        if (history_capacity < 0 || history_capacity == 1)
+            error("history_capacity should be 0 (no limit) or at least 2!");
+    } else if (key == "race_threads") {
+        race_threads = atoi(value.c_str());
+        if (race_threads < 0)
+            error("race_threads should be 0 (one per core) or more!");
     } else if (key == "stopping_criterion") {
         set_stopping_criterion_parameter(value);
+    } else if (key == "progress_recorder") {
+        set_progress_recorder_parameter(value);
     } else if (key == "restore_progress") {
         restore_progress = value;
     } else if (key == "restore_special_events") {
         restore_special_events = value;
     } else if (key == "restore_best_results") {
         restore_best_results = value;
+    } else if (key == "restore_best_tour") {
+        restore_best_tour = value;
     } else if (key == "output") {
         output = value;
+    } else if (key == "checkpoint") {
+        checkpoint_seconds = atof(value.c_str());
+        if (checkpoint_seconds < 0)
+            error("checkpoint should be 0 (none) or a number of seconds!");
+    } else if (key == "resume") {
+        resume = value;
+        if (resume != "on" && resume != "off")
+            error("resume should be `on` or `off`!");
     } else {
         error("This should never happen --> set_parameter()");
     }
@@ -133,26 +285,135 @@ inline void Configuration::set_stopping_criterion_parameter(string& value) {
         stopping.max_iteration = true;
         stopping.max_iteration_par = atoi(parameter.c_str());
     }
+    if (criterion == "list_convergence") {
+        stopping.list_convergence = true;
+        stopping.list_convergence_par = atol(parameter.c_str());
+    }
+}
+
+inline void Configuration::set_proposal_parameter(string& value) {
+    for (int i = 0; i < NUM_PROPOSALS; i++)
+        if (value == proposal_names[i]) {
+            mutation.proposal = (proposal_type) i;
+            return;
+        }
+    error("proposal should be `uniform`, `neighbour`, `or_opt` or `mixed`!");
+}
+
+inline void Configuration::set_mutation_policy_parameter(string& value) {
+    for (int i = 0; i < NUM_POLICIES; i++)
+        if (value == policy_names[i]) {
+            mutation.policy = (mutation_policy_type) i;
+            return;
+        }
+    error("mutation_policy should be `fixed`, `random` or `bandit`!");
+}
+
+inline void Configuration::set_progress_recorder_parameter(string& value) {
+    // the recorder, and optionally after a coma its parameter
+    size_t firstColomn = value.find_first_of(",");
+    string recorder = value.substr(0, firstColomn);
+    trim_string_blanks(recorder);
+    int i = 0;
+    while (i < NUM_RECORDERS && recorder != recorder_names[i])
+        i++;
+    if (i == NUM_RECORDERS)
+        error("progress_recorder should be `all`, `log` or `reservoir`!");
+    progress.recorder = (recorder_type) i;
+    if (firstColomn >= value.size())
+        return;
+    string parameter = value.substr(firstColomn + 1, value.size());
+    trim_string_blanks(parameter);
+    if (progress.recorder == LOG_RECORDER) {
+        progress.buckets = atoi(parameter.c_str());
+        if (progress.buckets < 1)
+            error("progress_recorder `log` needs at least 1 bucket!");
+    } else if (progress.recorder == RESERVOIR_RECORDER) {
+        progress.capacity = atoi(parameter.c_str());
+        if (progress.capacity < 4)
+            error("progress_recorder `reservoir` needs a capacity of at "
+                "least 4!");
+    }
+}
+
+inline void Configuration::set_migration_parameter(string& value) {
+    // the topology, and optionally after a coma the interval
+    size_t firstColomn = value.find_first_of(",");
+    string topology = value.substr(0, firstColomn);
+    trim_string_blanks(topology);
+    int i = 0;
+    while (i < NUM_MIGRATIONS && topology != migration_names[i])
+        i++;
+    if (i == NUM_MIGRATIONS)
+        error("migration should be `none`, `ring` or `broadcast`!");
+    island.migration = (migration_type) i;
+    if (firstColomn >= value.size())
+        return;
+    string parameter = value.substr(firstColomn + 1, value.size());
+    trim_string_blanks(parameter);
+    island.interval = atol(parameter.c_str());
+    if (island.interval < 1)
+        error("migration needs an interval of at least 1 iteration!");
 }
 
-string Configuration::dump_parameters() {
+string Configuration::dump_parameters(bool run_settings) {
     string parameters = "Application parameters set as the following:\n";
     parameters += std::string(10, ' ') + "inputfile:                      ";
     parameters += inputfile + "\n";
     parameters += std::string(10, ' ') + "problem_name:                   ";
     parameters += problem_name + "\n";
+    parameters += std::string(10, ' ') + "distance_backend:               ";
+    parameters += distance_backend + "\n";
+    if (distance_backend == "cache") {
+        parameters += std::string(10, ' ') + "distance_cache_mb:              ";
+        parameters += std::to_string(distance_cache_mb) + "\n";
+    }
+    parameters += std::string(10, ' ') + "renumbering:                    ";
+    parameters += renumbering + "\n";
     parameters += std::string(10, ' ') + "algorithm:                      ";
     parameters += algorithm + "\n";
     parameters += std::string(10, ' ') + "seed:                           ";
     parameters += std::to_string(seed) + "\n";
     parameters += std::string(10, ' ') + "num_run:                        ";
     parameters += std::to_string(num_run) + "\n";
+    if (run_settings) {
+        parameters += std::string(10, ' ') + "threads:                        ";
+        parameters += std::to_string(threads) + "\n";
+        parameters += std::string(10, ' ') + "pin_threads:                    ";
+        parameters += pin_threads + "\n";
+    }
     parameters += std::string(10, ' ') + "list_size:                      ";
     parameters += std::to_string(list_size) + "\n";
+    if (island.islands > 1) {
+        parameters += std::string(10, ' ') + "islands:                        ";
+        parameters += std::to_string(island.islands) + "\n";
+        parameters += std::string(10, ' ') + "migration:                      ";
+        parameters += string(migration_names[island.migration]);
+        if (island.migration != NO_MIGRATION)
+            parameters += ", " + std::to_string(island.interval);
+        parameters += "\n";
+    }
+    parameters += std::string(10, ' ') + "proposal:                       ";
+    parameters += string(proposal_names[mutation.proposal]) + "\n";
+    parameters += std::string(10, ' ') + "mutation_policy:                ";
+    parameters += string(policy_names[mutation.policy]) + "\n";
+    if (mutation.proposal == NEIGHBOUR_PROPOSAL) {
+        parameters += std::string(10, ' ') + "num_neighbours:                 ";
+        parameters += std::to_string(mutation.num_neighbours) + "\n";
+    }
+    parameters += std::string(10, ' ') + "tour_representation:            ";
+    parameters += string(mutation.two_level_list ? "two_level" : "array") +
+            "\n";
+    parameters += std::string(10, ' ') + "batch_size:                     ";
+    parameters += std::to_string(mutation.batch_size) + "\n";
     parameters += std::string(10, ' ') + "base_list_size:                 ";
     parameters += std::to_string(base_list_size) + "\n";
     parameters += std::string(10, ' ') + "list_scaling_size:              ";
     parameters += std::to_string(list_scaling_size) + "\n";
+    parameters += std::string(10, ' ') + "history_capacity:               ";
+    parameters += std::to_string(history_capacity) + "\n";
+    parameters += std::string(10, ' ') + "race_threads:                   ";
+    parameters += std::to_string(race_threads) + "\n";
     if (stopping.solution_quality == true) {
         parameters += std::string(10, ' ') + "stopping_criterion:             ";
         parameters += "solution_quality, " +
@@ -168,6 +429,18 @@ string Configuration::dump_parameters() {
         parameters += "point_of_convergence, " +
                 std::to_string(100. / stopping.point_of_convergence_par) + "\n";
     }
+    if (stopping.list_convergence == true) {
+        parameters += std::string(10, ' ') + "stopping_criterion:             ";
+        parameters += "list_convergence, " +
+                std::to_string(stopping.list_convergence_par) + "\n";
+    }
+    parameters += std::string(10, ' ') + "progress_recorder:              ";
+    parameters += string(recorder_names[progress.recorder]);
+    if (progress.recorder == LOG_RECORDER)
+        parameters += ", " + std::to_string(progress.buckets);
+    if (progress.recorder == RESERVOIR_RECORDER)
+        parameters += ", " + std::to_string(progress.capacity);
+    parameters += "\n";
     parameters += std::string(10, ' ') + "restore_progress:               ";
     parameters += restore_progress + "\n";
     parameters += std::string(10, ' ') + "log_file:                       ";
@@ -176,7 +449,17 @@ string Configuration::dump_parameters() {
     parameters += output + ".progress\n";
     parameters += std::string(10, ' ') + "best_obtained_results_file:     ";
     parameters += output + ".bests\n";
+    if (restore_best_tour == "on") {
+        parameters += std::string(10, ' ') + "best_tour_file:                 ";
+        parameters += output + ".tour\n";
+    }
     parameters += std::string(10, ' ') + "avg_file:                       ";
     parameters += output + ".avg\n";
+    if (run_settings) {
+        parameters += std::string(10, ' ') + "checkpoint:                     ";
+        parameters += std::to_string(checkpoint_seconds) + "\n";
+        parameters += std::string(10, ' ') + "resume:                         ";
+        parameters += resume + "\n";
+    }
     return parameters;
 }
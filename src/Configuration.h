@@ -31,36 +31,104 @@ typedef struct {
     double solution_quality_par;
     bool point_of_convergence;
     double point_of_convergence_par;
+    bool list_convergence;
+    long list_convergence_par; // idle iterations once the list is flat
 } stopping_criteria;
 
+typedef enum {
+    UNIFORM_PROPOSAL, // 'double_bridge'
+    NEIGHBOUR_PROPOSAL, // 'neighbour_2opt'
+    OR_OPT_PROPOSAL, // 'or_opt'
+    MIXED_PROPOSAL // 'double_bridge' or 'or_opt', with equal probability
+} proposal_type;
+
+typedef enum {
+    FIXED_POLICY, // the operator of `proposal`
+    RANDOM_POLICY, // an operator uniformly at random (see OperatorSelector)
+    BANDIT_POLICY // the operator that is paying off (see OperatorSelector)
+} mutation_policy_type;
+
+typedef struct {
+    proposal_type proposal;
+    mutation_policy_type policy;
+    int num_neighbours;
+    bool two_level_list; // `tour_representation: two_level`
+    int batch_size; // most moves drawn and evaluated at once
+} mutation_settings;
+
+typedef enum {
+    ALL_RECORDER, // every improvement
+    LOG_RECORDER, // the last improvement of each log-spaced iteration bucket
+    RESERVOIR_RECORDER // at most 'capacity' records, within a tolerance
+} recorder_type;
+
+typedef struct {
+    recorder_type recorder;
+    int buckets; // buckets per doubling of the iteration, for `log`
+    int capacity; // most records of a run, for `reservoir`
+} progress_settings;
+
+typedef enum {
+    NO_MIGRATION, // the islands are independent chains
+    RING_MIGRATION, // from the island before, in a ring
+    BROADCAST_MIGRATION // from the best of the other islands
+} migration_type;
+
+typedef struct {
+    int islands; // LAHC chains run at once, 1 for a plain LAHC
+    migration_type migration;
+    long interval; // iterations of an island between two migrations
+} island_settings;
+
 class Configuration {
 public:
     string inputfile;
     // TSP PARAMETERS
     string problem_name;
+    string distance_backend;
+    int distance_cache_mb; // budget of the `cache` distance backend
+    string renumbering; // order of the city ids: `none` or `hilbert`
     // GENERAL PARAMETERS
     string algorithm;
     int seed;
     int num_run;
+    int threads; // of the runs, 0 for one per core
+    string pin_threads; // bind each thread to a core
     // LAHC PARAMETERS
     int list_size;
+    island_settings island;
+    // MUTATION PARAMETERS
+    mutation_settings mutation;
     // INCRIMENTAL LAHC PARAMETERS
     int base_list_size;
     int list_scaling_size;  
+    int history_capacity; // most entries of the pLAHC-s history, 0 for all
+    int race_threads; // lists of pLAHC run at once, 0 for one per core
     // STOPPING CRITERION PARAMETERS
     stopping_criteria stopping;
     // STORE DATA PARAMETERS
+    progress_settings progress;
     string restore_progress;
     string restore_special_events;
     string restore_best_results;
+    string restore_best_tour; // best tour of each run, in the file's ids
     string output;
+    // CHECKPOINT PARAMETERS
+    double checkpoint_seconds; // between two checkpoints, 0 for none
+    string resume; // go on from <output>.ckpt, if it exists
     Configuration(string input);
-    string dump_parameters();
+    // without the threads, pinning and checkpoints, for the fingerprint of
+    // a checkpoint
+    string dump_parameters(bool run_settings = true);
     
 private:
     // Tools used for reading inputfile
     void set_parameter(string &key, string &value);
     inline void set_stopping_criterion_parameter(string &value);
+    inline void set_proposal_parameter(string &value);
+    inline void set_mutation_policy_parameter(string &value);
+    inline void set_progress_recorder_parameter(string &value);
+    inline void set_migration_parameter(string &value);
     void read_inputfile(ifstream &inputfile);
 };
 
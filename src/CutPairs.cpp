@@ -0,0 +1,135 @@
+/*
+ * File:    CutPairs.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: A buffer of random cut pairs for the 2-opt moves, drawn
+ * from xoshiro256** streams stepped in SIMD lanes.
+ *
+ */
+
+#include "CutPairs.h"
+
+using namespace std;
+
+CutPairs::CutPairs() {
+    num_cities = 0;
+    threshold0 = threshold1 = 0;
+    random = NULL;
+    used = CUT_PAIR_BLOCK;
+}
+
+void CutPairs::init(int n, RandomStream *stream) {
+    num_cities = n;
+    threshold0 = (uint32_t) (-(uint32_t) n) % (uint32_t) n;
+    threshold1 = (uint32_t) (-(uint32_t) (n - 1)) % (uint32_t) (n - 1);
+    random = stream;
+    uint64_t key = stream->next();
+    for (int lane = 0; lane < CUT_PAIR_LANES; lane++) {
+        RandomStream seeder(RandomStream::derive(key, lane));
+        for (int i = 0; i < 4; i++)
+            state[i][lane] = seeder.next();
+    }
+    used = CUT_PAIR_BLOCK;
+}
+
+void CutPairs::save(CheckpointOut &out) const {
+    out.put_array(&state[0][0], 4 * CUT_PAIR_LANES);
+    out.put_array(pairs, 2 * CUT_PAIR_BLOCK);
+    out.put(used);
+}
+
+void CutPairs::load(CheckpointIn &in) {
+    in.get_array(&state[0][0], 4 * CUT_PAIR_LANES);
+    in.get_array(pairs, 2 * CUT_PAIR_BLOCK);
+    in.get(used);
+}
+
+void CutPairs::fill() {
+    uint32_t n = num_cities;
+    uint64_t words[CUT_PAIR_LANES];
+    for (int k = 0; k < CUT_PAIR_BLOCK; k += CUT_PAIR_LANES) {
+        next_words(words);
+        for (int lane = 0; lane < CUT_PAIR_LANES; lane++) {
+            uint64_t m0 = (words[lane] >> 32) * (uint64_t) n;
+            uint64_t m1 = (words[lane] & 0xffffffffULL) * (uint64_t) (n - 1);
+            uint32_t c0 = (uint32_t) (m0 >> 32);
+            uint32_t c1 = (uint32_t) (m1 >> 32);
+            if ((uint32_t) m0 < threshold0)
+                c0 = random->below(n);
+            if ((uint32_t) m1 < threshold1)
+                c1 = random->below(n - 1);
+            c1 += (c1 >= c0);
+            int *pair = pairs + 2 * (k + lane);
+            pair[0] = c0 < c1 ? c0 : c1;
+            pair[1] = c0 < c1 ? c1 : c0;
+        }
+    }
+    used = 0;
+}
+
+void CutPairs::next_words(uint64_t *words) {
+    // one xoshiro256** step of every lane:
+    //     result = rotl(s1 * 5, 7) * 9, t = s1 << 17,
+    //     s2 ^= s0, s3 ^= s1, s1 ^= s2, s0 ^= s3, s2 ^= t, s3 = rotl(s3, 45)
+    // with x * 5 = (x << 2) + x and x * 9 = (x << 3) + x, as SSE2 and AVX2
+    // have no 64-bit multiply
+#if defined(__AVX2__)
+    __m256i s0 = _mm256_loadu_si256((const __m256i *) state[0]);
+    __m256i s1 = _mm256_loadu_si256((const __m256i *) state[1]);
+    __m256i s2 = _mm256_loadu_si256((const __m256i *) state[2]);
+    __m256i s3 = _mm256_loadu_si256((const __m256i *) state[3]);
+    __m256i x = _mm256_add_epi64(_mm256_slli_epi64(s1, 2), s1);
+    x = _mm256_or_si256(_mm256_slli_epi64(x, 7), _mm256_srli_epi64(x, 57));
+    x = _mm256_add_epi64(_mm256_slli_epi64(x, 3), x);
+    _mm256_storeu_si256((__m256i *) words, x);
+    __m256i t = _mm256_slli_epi64(s1, 17);
+    s2 = _mm256_xor_si256(s2, s0);
+    s3 = _mm256_xor_si256(s3, s1);
+    s1 = _mm256_xor_si256(s1, s2);
+    s0 = _mm256_xor_si256(s0, s3);
+    s2 = _mm256_xor_si256(s2, t);
+    s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45),
+            _mm256_srli_epi64(s3, 19));
+    _mm256_storeu_si256((__m256i *) state[0], s0);
+    _mm256_storeu_si256((__m256i *) state[1], s1);
+    _mm256_storeu_si256((__m256i *) state[2], s2);
+    _mm256_storeu_si256((__m256i *) state[3], s3);
+#elif defined(__SSE2__)
+    for (int half = 0; half < CUT_PAIR_LANES; half += 2) {
+        __m128i s0 = _mm_loadu_si128((const __m128i *) (state[0] + half));
+        __m128i s1 = _mm_loadu_si128((const __m128i *) (state[1] + half));
+        __m128i s2 = _mm_loadu_si128((const __m128i *) (state[2] + half));
+        __m128i s3 = _mm_loadu_si128((const __m128i *) (state[3] + half));
+        __m128i x = _mm_add_epi64(_mm_slli_epi64(s1, 2), s1);
+        x = _mm_or_si128(_mm_slli_epi64(x, 7), _mm_srli_epi64(x, 57));
+        x = _mm_add_epi64(_mm_slli_epi64(x, 3), x);
+        _mm_storeu_si128((__m128i *) (words + half), x);
+        __m128i t = _mm_slli_epi64(s1, 17);
+        s2 = _mm_xor_si128(s2, s0);
+        s3 = _mm_xor_si128(s3, s1);
+        s1 = _mm_xor_si128(s1, s2);
+        s0 = _mm_xor_si128(s0, s3);
+        s2 = _mm_xor_si128(s2, t);
+        s3 = _mm_or_si128(_mm_slli_epi64(s3, 45), _mm_srli_epi64(s3, 19));
+        _mm_storeu_si128((__m128i *) (state[0] + half), s0);
+        _mm_storeu_si128((__m128i *) (state[1] + half), s1);
+        _mm_storeu_si128((__m128i *) (state[2] + half), s2);
+        _mm_storeu_si128((__m128i *) (state[3] + half), s3);
+    }
+#else
+    for (int lane = 0; lane < CUT_PAIR_LANES; lane++) {
+        uint64_t s1 = state[1][lane];
+        uint64_t x = s1 * 5;
+        x = (x << 7) | (x >> 57);
+        words[lane] = x * 9;
+        uint64_t t = s1 << 17;
+        state[2][lane] ^= state[0][lane];
+        state[3][lane] ^= s1;
+        state[1][lane] ^= state[2][lane];
+        state[0][lane] ^= state[3][lane];
+        state[2][lane] ^= t;
+        state[3][lane] = (state[3][lane] << 45) | (state[3][lane] >> 19);
+    }
+#endif
+}
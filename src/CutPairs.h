@@ -0,0 +1,69 @@
+/*
+ * File:    CutPairs.h
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: A buffer of random cut pairs for the 2-opt moves. A pair is
+ * two distinct positions c0 < c1 in 0..n-1, uniformly at random. The
+ * buffer is filled CUT_PAIR_BLOCK pairs at a time, so that the moves take
+ * their cuts with a load and a compare ('next'), with no call of the
+ * generator, no test for equal cuts and no allocation.
+ * The random words come from CUT_PAIR_LANES xoshiro256** streams that are
+ * stepped together, in one AVX2 register or two SSE2 registers when the
+ * build enables them; all paths give the same words. One 64-bit word makes
+ * one pair: its high half draws c0 in 0..n-1 and its low half c1 in
+ * 0..n-2, both by the multiply-shift of Lemire (2019), and c1 skips c0.
+ * A draw that the multiply-shift would bias, about n in 2^32 of them, is
+ * drawn again from the stream of the run, so the pairs are unbiased.
+ * The lanes are seeded from the stream of the run, so the pairs are as
+ * reproducible as the run.
+ *
+ * Created on October 17, 2026
+ */
+
+#ifndef CUTPAIRS_H
+#define CUTPAIRS_H
+
+#include "RandomStream.h"
+#include "Checkpoint.h"
+#include <stdint.h>
+#include <stddef.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define CUT_PAIR_BLOCK 256 // pairs made by one 'fill'
+#define CUT_PAIR_LANES 4 // xoshiro256** streams stepped together
+
+class CutPairs {
+public:
+    CutPairs();
+    void init(int n, RandomStream *stream);
+    void save(CheckpointOut &out) const;
+    void load(CheckpointIn &in);
+
+    // cuts[0] < cuts[1], the next pair of the buffer
+    inline void next(int *cuts) {
+        if (used == CUT_PAIR_BLOCK)
+            fill();
+        cuts[0] = pairs[2 * used];
+        cuts[1] = pairs[2 * used + 1];
+        used++;
+    }
+
+private:
+    int num_cities;
+    uint32_t threshold0; // 2^32 mod n: lower products are redrawn
+    uint32_t threshold1; // 2^32 mod (n - 1)
+    RandomStream *random; // the stream of the run, for the redraws
+    uint64_t state[4][CUT_PAIR_LANES]; // word i of the state of each lane
+    int pairs[2 * CUT_PAIR_BLOCK];
+    int used; // pairs taken from the buffer
+
+    void fill();
+    void next_words(uint64_t *words);
+};
+
+#endif /* CUTPAIRS_H */
@@ -0,0 +1,464 @@
+/*
+ * File:    DistanceMatrix.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: Distances between the cities of a TSP instance, either as a
+ * full matrix or computed on demand from the coordinates of the cities.
+ *
+ */
+
+#include "DistanceMatrix.h"
+#include <string.h>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+#define CACHE_LINE 64
+#define MAX_NARROW_WEIGHT 65535
+#define ROWS_PER_TASK 16
+#define MIRROR_TILE 64
+#define EMPTY_TILE (~(uint32_t) 0)
+
+namespace {
+
+    // calls 'body(begin, end)' on chunks of [0, count) from 'num_threads'
+    // threads; a thread takes the next chunk as soon as it is free
+    void parallel_for(int count, int chunk, int num_threads,
+            const std::function<void(int, int) > &body) {
+        std::atomic<int> next(0);
+        auto worker = [&]() {
+            for (;;) {
+                int begin = next.fetch_add(chunk);
+                if (begin >= count)
+                    return;
+                body(begin, std::min(count, begin + chunk));
+            }
+        };
+        std::vector<std::thread> pool;
+        for (int t = 1; t < num_threads; t++)
+            pool.push_back(std::thread(worker));
+        worker();
+        for (size_t t = 0; t < pool.size(); t++)
+            pool[t].join();
+    }
+
+    // out[j] = distance(i, j) for j in [begin, end), with the TSPLIB
+    // rounding of EUC_2D or CEIL_2D; 'xi' and 'yi' are the coordinates of i
+    void row_distances_scalar(double xi, double yi, const double *x,
+            const double *y, bool ceiling, int begin, int end, int *out) {
+        for (int j = begin; j < end; j++) {
+            double xd = xi - x[j];
+            double yd = yi - y[j];
+            double dist = sqrt(xd * xd + yd * yd);
+            out[j] = ceiling ? (int) ceil(dist) : (int) (dist + 0.5);
+        }
+    }
+
+#if defined(__x86_64__)
+
+    // SSE2 is part of x86-64; two distances per instruction
+    void row_distances_sse2(double xi, double yi, const double *x,
+            const double *y, bool ceiling, int begin, int end, int *out) {
+        __m128d vxi = _mm_set1_pd(xi);
+        __m128d vyi = _mm_set1_pd(yi);
+        __m128d half = _mm_set1_pd(0.5);
+        int j = begin;
+        for (; j + 2 <= end; j += 2) {
+            __m128d xd = _mm_sub_pd(vxi, _mm_loadu_pd(x + j));
+            __m128d yd = _mm_sub_pd(vyi, _mm_loadu_pd(y + j));
+            __m128d dist = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(xd, xd),
+                    _mm_mul_pd(yd, yd)));
+            __m128i rounded;
+            if (ceiling) {
+                __m128i t = _mm_cvttpd_epi32(dist);
+                __m128i up = _mm_castpd_si128(_mm_cmplt_pd(
+                        _mm_cvtepi32_pd(t), dist));
+                up = _mm_shuffle_epi32(up, _MM_SHUFFLE(3, 3, 2, 0));
+                rounded = _mm_sub_epi32(t, up);
+            } else
+                rounded = _mm_cvttpd_epi32(_mm_add_pd(dist, half));
+            _mm_storel_epi64((__m128i *) (out + j), rounded);
+        }
+        row_distances_scalar(xi, yi, x, y, ceiling, j, end, out);
+    }
+
+    // four distances per instruction on CPUs with AVX
+    __attribute__((target("avx")))
+    void row_distances_avx(double xi, double yi, const double *x,
+            const double *y, bool ceiling, int begin, int end, int *out) {
+        __m256d vxi = _mm256_set1_pd(xi);
+        __m256d vyi = _mm256_set1_pd(yi);
+        __m256d half = _mm256_set1_pd(0.5);
+        int j = begin;
+        for (; j + 4 <= end; j += 4) {
+            __m256d xd = _mm256_sub_pd(vxi, _mm256_loadu_pd(x + j));
+            __m256d yd = _mm256_sub_pd(vyi, _mm256_loadu_pd(y + j));
+            __m256d dist = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(xd, xd),
+                    _mm256_mul_pd(yd, yd)));
+            dist = ceiling ? _mm256_ceil_pd(dist) : _mm256_add_pd(dist, half);
+            _mm_storeu_si128((__m128i *) (out + j),
+                    _mm256_cvttpd_epi32(dist));
+        }
+        row_distances_scalar(xi, yi, x, y, ceiling, j, end, out);
+    }
+
+    typedef void (*row_kernel)(double, double, const double *,
+            const double *, bool, int, int, int *);
+
+    row_kernel select_row_kernel() {
+        if (__builtin_cpu_supports("avx"))
+            return row_distances_avx;
+        return row_distances_sse2;
+    }
+#else
+
+    typedef void (*row_kernel)(double, double, const double *,
+            const double *, bool, int, int, int *);
+
+    row_kernel select_row_kernel() {
+        return row_distances_scalar;
+    }
+#endif
+}
+
+DistanceMatrix::DistanceMatrix() {
+    storage = MATRIX_32;
+    num_cities = 0;
+    width = 4;
+    stride = 0;
+    data16 = NULL;
+    data32 = NULL;
+    x = NULL;
+    y = NULL;
+    row_offset = NULL;
+    tile_sets = NULL;
+    hits = 0;
+    misses = 0;
+    owner = true;
+}
+
+DistanceMatrix::~DistanceMatrix() {
+    release();
+}
+
+void DistanceMatrix::release() {
+    if (owner) {
+        free(data16);
+        free(data32);
+    }
+    free(x);
+    free(y);
+    free(row_offset);
+    free(tile_sets);
+    data16 = NULL;
+    data32 = NULL;
+    x = NULL;
+    y = NULL;
+    row_offset = NULL;
+    tile_sets = NULL;
+    hits = 0;
+    misses = 0;
+    owner = true;
+}
+
+void *DistanceMatrix::aligned_block(size_t bytes) {
+    void *block = NULL;
+    if (posix_memalign(&block, CACHE_LINE, bytes) != 0)
+        error("Couldn't allocate memory for the distance matrix!");
+    return block;
+}
+
+void DistanceMatrix::allocate(int n, long max_weight, bool triangular) {
+    // 'max_weight' is an upper bound of the edge weights to be stored; it
+    // decides the element width of the matrix
+    release();
+    num_cities = n;
+    width = (max_weight >= 0 && max_weight <= MAX_NARROW_WEIGHT) ? 2 : 4;
+    if (triangular) {
+        storage = (width == 2) ? TRIANGLE_16 : TRIANGLE_32;
+        stride = 0;
+        set_row_offsets();
+    } else {
+        storage = (width == 2) ? MATRIX_16 : MATRIX_32;
+        size_t per_line = CACHE_LINE / width;
+        stride = (n + per_line - 1) / per_line * per_line;
+    }
+    if (width == 2)
+        data16 = (uint16_t *) aligned_block(num_elements() * width);
+    else
+        data32 = (int *) aligned_block(num_elements() * width);
+}
+
+void DistanceMatrix::set_row_offsets() {
+    // row i of the triangle holds the columns i..n-1, so it starts after
+    // i * n - i * (i - 1) / 2 entries
+    row_offset = (size_t *) aligned_block(sizeof (size_t) * num_cities);
+    size_t start = 0;
+    for (int i = 0; i < num_cities; i++) {
+        row_offset[i] = start - i;
+        start += num_cities - i;
+    }
+}
+
+size_t DistanceMatrix::num_elements() const {
+    if (is_triangular())
+        return (size_t) num_cities * (num_cities + 1) / 2;
+    return stride * num_cities;
+}
+
+void DistanceMatrix::narrow() {
+    // move a matrix stored with 'int' elements to 'uint16_t' elements if all
+    // of its weights fit
+    if (storage != MATRIX_32 && storage != TRIANGLE_32)
+        return;
+    bool triangular = is_triangular();
+    for (int i = 0; i < num_cities; i++)
+        for (int j = triangular ? i : 0; j < num_cities; j++)
+            if ((*this)(i, j) < 0 || (*this)(i, j) > MAX_NARROW_WEIGHT)
+                return;
+    int *wide_data = data32;
+    size_t wide_stride = stride;
+    size_t *wide_row_offset = row_offset;
+    data32 = NULL;
+    row_offset = NULL;
+    allocate(num_cities, MAX_NARROW_WEIGHT, triangular);
+    if (triangular) {
+        for (size_t e = 0; e < num_elements(); e++)
+            data16[e] = (uint16_t) wide_data[e];
+    } else
+        for (int i = 0; i < num_cities; i++)
+            for (int j = 0; j < num_cities; j++)
+                data16[i * stride + j] = (uint16_t) wide_data[i * wide_stride
+                    + j];
+    free(wide_data);
+    free(wide_row_offset);
+}
+
+void DistanceMatrix::fill_from_coordinates(const double *x, const double *y,
+        bool ceiling, int num_threads) {
+    // The matrix is symmetric and d(i, j) is computed exactly as d(j, i),
+    // so only the upper triangle is computed and the lower one is a copy.
+    // Both passes split the rows among 'num_threads' threads (all hardware
+    // threads if it is 0).
+    if (num_threads <= 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    parallel_for(num_cities, ROWS_PER_TASK, num_threads,
+            [this, x, y, ceiling](int begin, int end) {
+                fill_upper_rows(x, y, ceiling, begin, end);
+            });
+    if (!is_triangular())
+        parallel_for(num_cities, MIRROR_TILE, num_threads,
+            [this](int begin, int end) {
+                mirror_upper_rows(begin, end);
+            });
+}
+
+void DistanceMatrix::fill_upper_rows(const double *x, const double *y,
+        bool ceiling, int begin, int end) {
+    row_kernel kernel = select_row_kernel();
+    std::vector<int> row(num_cities);
+    for (int i = begin; i < end; i++) {
+        kernel(x[i], y[i], x, y, ceiling, i, num_cities, row.data());
+        // 'row_start' is the index of (i, 0), so (i, j) is at row_start + j
+        size_t row_start = is_triangular() ? row_offset[i] :
+                (size_t) i * stride;
+        if (width == 2) {
+            uint16_t *out = data16 + row_start;
+            for (int j = i; j < num_cities; j++)
+                out[j] = (uint16_t) row[j];
+        } else {
+            int *out = data32 + row_start;
+            for (int j = i; j < num_cities; j++)
+                out[j] = row[j];
+        }
+    }
+}
+
+void DistanceMatrix::mirror_upper_rows(int begin, int end) {
+    // copy d(j, i) into d(i, j) for j < i, tile by tile to stay in cache
+    for (int tile = 0; tile < end; tile += MIRROR_TILE)
+        for (int i = begin; i < end; i++)
+            for (int j = tile; j < std::min(i, tile + MIRROR_TILE); j++)
+                set(i, j, (*this)(j, i));
+}
+
+void DistanceMatrix::use_coordinates(int n, const double *x, const double *y,
+        bool ceiling) {
+    // keep a structure-of-arrays copy of the coordinates and compute the
+    // distances on demand
+    release();
+    num_cities = n;
+    width = 4;
+    stride = 0;
+    storage = ceiling ? CEIL_2D_COORDINATES : EUC_2D_COORDINATES;
+    this->x = (double *) aligned_block(sizeof (double) * n);
+    this->y = (double *) aligned_block(sizeof (double) * n);
+    for (int i = 0; i < n; i++) {
+        this->x[i] = x[i];
+        this->y[i] = y[i];
+    }
+}
+
+void DistanceMatrix::map_matrix(int n, int element_width, size_t row_stride,
+        const void *rows, bool triangular) {
+    // use rows that are owned by somebody else, e.g. a read-only mapping of
+    // a .tspb file; set() must not be called on such a matrix
+    release();
+    num_cities = n;
+    width = element_width;
+    stride = triangular ? 0 : row_stride;
+    if (triangular) {
+        storage = (width == 2) ? TRIANGLE_16 : TRIANGLE_32;
+        set_row_offsets();
+    } else
+        storage = (width == 2) ? MATRIX_16 : MATRIX_32;
+    if (width == 2)
+        data16 = (uint16_t *) rows;
+    else
+        data32 = (int *) rows;
+    owner = false;
+}
+
+void DistanceMatrix::use_tile_cache(int n, const double *x, const double *y,
+        bool ceiling, long max_weight, size_t budget_mb) {
+    // the coordinates are kept as for the coordinates storage; the tiles
+    // take as many slots as fit in 'budget_mb'
+    use_coordinates(n, x, y, ceiling);
+    storage = TILE_CACHE;
+    ceiling_tiles = ceiling;
+    width = (max_weight >= 0 && max_weight <= MAX_NARROW_WEIGHT) ? 2 : 4;
+    tiles_per_side = (n + DISTANCE_TILE - 1) / DISTANCE_TILE;
+    if (tiles_per_side * tiles_per_side >= EMPTY_TILE)
+        error("Too many cities for the `cache` distance backend!");
+    size_t tile_bytes = (size_t) DISTANCE_TILE * DISTANCE_TILE * width;
+    size_t num_sets = 1;
+    set_shift = 64;
+    while (2 * num_sets * DISTANCE_CACHE_WAYS * tile_bytes <=
+            budget_mb * 1024 * 1024) {
+        num_sets *= 2;
+        set_shift--;
+    }
+    set_mask = num_sets - 1;
+    set_shift = std::min(set_shift, 63);
+    size_t num_slots = num_sets * DISTANCE_CACHE_WAYS;
+    if (width == 2)
+        data16 = (uint16_t *) aligned_block(num_slots * tile_bytes);
+    else
+        data32 = (int *) aligned_block(num_slots * tile_bytes);
+    tile_sets = (tile_set *) aligned_block(sizeof (tile_set) * num_sets);
+    memset(tile_sets, 0, sizeof (tile_set) * num_sets);
+    for (size_t set = 0; set < num_sets; set++)
+        for (int way = 0; way < DISTANCE_CACHE_WAYS; way++)
+            tile_sets[set].tags[way] = EMPTY_TILE;
+}
+
+size_t DistanceMatrix::load_tile(uint32_t tag, size_t set) const {
+    // CLOCK: the hand skips, and clears, the ways used since its last
+    // visit; the first way that was not used is replaced
+    tile_set &ways = tile_sets[set];
+    int way;
+    for (;;) {
+        way = ways.hand;
+        ways.hand = (ways.hand + 1) % DISTANCE_CACHE_WAYS;
+        if ((ways.used & (1 << way)) == 0)
+            break;
+        ways.used &= ~(1 << way);
+    }
+    ways.tags[way] = tag;
+    ways.used |= 1 << way;
+    size_t slot = set * DISTANCE_CACHE_WAYS + way;
+
+    // compute the tile row by row with the SIMD row kernel
+    int row_begin = (tag / tiles_per_side) * DISTANCE_TILE;
+    int column_begin = (tag % tiles_per_side) * DISTANCE_TILE;
+    int row_end = std::min(num_cities, row_begin + DISTANCE_TILE);
+    int column_end = std::min(num_cities, column_begin + DISTANCE_TILE);
+    static row_kernel kernel = select_row_kernel();
+    int row[DISTANCE_TILE];
+    size_t tile_start = slot * DISTANCE_TILE * DISTANCE_TILE;
+    for (int i = row_begin; i < row_end; i++) {
+        kernel(x[i], y[i], x + column_begin, y + column_begin, ceiling_tiles,
+                0, column_end - column_begin, row);
+        size_t out = tile_start + (size_t) (i - row_begin) * DISTANCE_TILE;
+        for (int j = 0; j < column_end - column_begin; j++)
+            if (width == 2)
+                data16[out + j] = (uint16_t) row[j];
+            else
+                data32[out + j] = row[j];
+    }
+    return slot;
+}
+
+bool DistanceMatrix::is_matrix() const {
+    return storage == MATRIX_16 || storage == MATRIX_32 || is_triangular();
+}
+
+bool DistanceMatrix::is_triangular() const {
+    return storage == TRIANGLE_16 || storage == TRIANGLE_32;
+}
+
+int DistanceMatrix::dimension() const {
+    return num_cities;
+}
+
+int DistanceMatrix::element_width() const {
+    return width;
+}
+
+size_t DistanceMatrix::row_stride() const {
+    return stride;
+}
+
+const void *DistanceMatrix::rows() const {
+    if (!is_matrix())
+        return NULL;
+    return (width == 2) ? (const void *) data16 : (const void *) data32;
+}
+
+bool DistanceMatrix::is_cache() const {
+    return storage == TILE_CACHE;
+}
+
+long DistanceMatrix::cache_hits() const {
+    return hits;
+}
+
+long DistanceMatrix::cache_misses() const {
+    return misses;
+}
+
+size_t DistanceMatrix::memory_usage() const {
+    if (is_matrix())
+        return num_elements() * width;
+    if (is_cache())
+        return (set_mask + 1) * (DISTANCE_CACHE_WAYS * DISTANCE_TILE *
+            DISTANCE_TILE * width + sizeof (tile_set)) +
+            2 * sizeof (double) * num_cities;
+    return 2 * sizeof (double) * num_cities;
+}
+
+string DistanceMatrix::describe() const {
+    if (is_matrix())
+        return string(is_triangular() ? "triangular" : "full") +
+            " matrix, " + std::to_string(8 * width) +
+            "-bit elements, " + std::to_string(memory_usage() / (1024 * 1024))
+            + " MB" + (owner ? "" : " (mapped)");
+    if (is_cache())
+        return "tile cache of " + std::to_string((set_mask + 1) *
+            DISTANCE_CACHE_WAYS) + " tiles of " + std::to_string(
+            DISTANCE_TILE) + "x" + std::to_string(DISTANCE_TILE) + " " +
+            std::to_string(8 * width) + "-bit distances (" +
+            std::to_string(DISTANCE_CACHE_WAYS) + "-way, CLOCK), " +
+            (ceiling_tiles ? "CEIL_2D" : "EUC_2D") + ", " +
+            std::to_string(memory_usage() / (1024 * 1024)) + " MB";
+    return string("computed from coordinates (") +
+            (storage == EUC_2D_COORDINATES ? "EUC_2D" : "CEIL_2D") + "), " +
+            std::to_string(memory_usage() / 1024) + " KB";
+}
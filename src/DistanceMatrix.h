@@ -0,0 +1,350 @@
+/*
+ * File:    DistanceMatrix.h
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: Distances between the cities of a TSP instance. It supports
+ * the following storages:
+ *      1- Full matrix: all rows live in one aligned block and an entry is
+ *         found at 'row * stride + col'. Each row starts on a cache line
+ *         boundary. The element width is selected when the matrix is
+ *         allocated: uint16_t, if the maximum edge weight fits in 16 bits,
+ *         or int otherwise.
+ *      2- Triangular matrix: all edge weights are symmetric, so only the
+ *         upper triangle (with the diagonal) is stored, row after row
+ *         without padding, in half of the memory. The entry (i, j) is found
+ *         at 'row_offset[min(i, j)] + max(i, j)'.
+ *      3- Coordinates: no matrix at all. The distances are computed on demand
+ *         (EUC_2D or CEIL_2D, with the TSPLIB rounding) from a
+ *         structure-of-arrays copy of the city coordinates. Memory is O(N),
+ *         so instances with millions of cities can be used.
+ *      4- Tile cache: the matrix is split in square tiles of
+ *         DISTANCE_TILE x DISTANCE_TILE cities, and a tile is computed from
+ *         the coordinates when one of its distances is read for the first
+ *         time. The tiles live in a cache of fixed size, set-associative
+ *         with DISTANCE_CACHE_WAYS ways per set, and a CLOCK (second chance)
+ *         policy picks the tile to evict in a full set. The tags and the
+ *         CLOCK state of a set share one cache line. Only the tiles of
+ *         the upper triangle are kept. The hits and misses are counted.
+ * A full matrix built from coordinates is filled by a pool of threads: only
+ * the upper triangle is computed, with SIMD sqrt, and then mirrored.
+ * A full matrix can also be mapped from a preprocessed instance file (see
+ * TSPB.h); the mapped rows are read-only and are not owned by this object.
+ * The mutation operators do not know which storage is in use; they read
+ * single distances through operator() and the edges of a move through
+ * distances4(), which evaluates four edges at once with SIMD instructions
+ * for the coordinates storage (SSE2, or AVX2 gathers when the build
+ * enables them), or through distances() for a batch of moves.
+ *
+ * Created on October 17, 2026
+ */
+
+#ifndef DISTANCEMATRIX_H
+#define DISTANCEMATRIX_H
+
+#include "Util.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+enum distance_storage {
+    MATRIX_16,
+    MATRIX_32,
+    TRIANGLE_16,
+    TRIANGLE_32,
+    TILE_CACHE,
+    EUC_2D_COORDINATES,
+    CEIL_2D_COORDINATES
+};
+
+#define DISTANCE_TILE_SHIFT 3
+#define DISTANCE_TILE (1 << DISTANCE_TILE_SHIFT)
+#define DISTANCE_CACHE_WAYS 8
+
+// one set of the tile cache, in one cache line
+typedef struct {
+    uint32_t tags[DISTANCE_CACHE_WAYS]; // the tile in each way, or EMPTY_TILE
+    uint8_t used; // CLOCK reference bits, one per way
+    uint8_t hand; // next way to check for eviction
+    uint8_t padding[64 - 4 * DISTANCE_CACHE_WAYS - 2];
+} tile_set;
+
+class DistanceMatrix {
+public:
+    DistanceMatrix();
+    ~DistanceMatrix();
+    void allocate(int num_cities, long max_weight, bool triangular = false);
+    void narrow();
+    void fill_from_coordinates(const double *x, const double *y,
+            bool ceiling, int num_threads = 0);
+    void use_coordinates(int num_cities, const double *x, const double *y,
+            bool ceiling);
+    void map_matrix(int num_cities, int width, size_t stride,
+            const void *rows, bool triangular = false);
+    void use_tile_cache(int num_cities, const double *x, const double *y,
+            bool ceiling, long max_weight, size_t budget_mb);
+    bool is_matrix() const;
+    bool is_triangular() const;
+    int dimension() const;
+    int element_width() const;
+    size_t row_stride() const;
+    const void *rows() const;
+    bool is_cache() const;
+    long cache_hits() const;
+    long cache_misses() const;
+    size_t memory_usage() const;
+    string describe() const;
+
+    inline int operator()(int city1, int city2) const {
+        switch (storage) {
+            case MATRIX_16:
+                return data16[(size_t) city1 * stride + city2];
+            case MATRIX_32:
+                return data32[(size_t) city1 * stride + city2];
+            case TRIANGLE_16:
+                return data16[packed_index(city1, city2)];
+            case TRIANGLE_32:
+                return data32[packed_index(city1, city2)];
+            case TILE_CACHE:
+                return cached_distance(city1, city2);
+            case EUC_2D_COORDINATES:
+                return (int) (sqrt(square_distance(city1, city2)) + 0.5);
+            default: // CEIL_2D_COORDINATES
+                return (int) ceil(sqrt(square_distance(city1, city2)));
+        }
+    }
+
+    // out[k] = distance(from[k], to[k]) for k = 0..3
+    inline void distances4(const int *from, const int *to, int *out) const {
+        switch (storage) {
+            case MATRIX_16:
+                for (int k = 0; k < 4; k++)
+                    out[k] = data16[(size_t) from[k] * stride + to[k]];
+                return;
+            case MATRIX_32:
+                for (int k = 0; k < 4; k++)
+                    out[k] = data32[(size_t) from[k] * stride + to[k]];
+                return;
+            case TRIANGLE_16:
+                for (int k = 0; k < 4; k++)
+                    out[k] = data16[packed_index(from[k], to[k])];
+                return;
+            case TRIANGLE_32:
+                for (int k = 0; k < 4; k++)
+                    out[k] = data32[packed_index(from[k], to[k])];
+                return;
+            case TILE_CACHE:
+                for (int k = 0; k < 4; k++)
+                    out[k] = cached_distance(from[k], to[k]);
+                return;
+            default:
+                coordinate_distances4(from, to, out);
+                return;
+        }
+    }
+
+    // out[k] = distance(from[k], to[k]) for k < count, a multiple of 4. The
+    // storage is looked up once, and the loads of the batch do not depend
+    // on each other, so the memory system overlaps them
+    inline void distances(const int *from, const int *to, int *out,
+            int count) const {
+        switch (storage) {
+            case MATRIX_16:
+                for (int k = 0; k < count; k++)
+                    out[k] = data16[(size_t) from[k] * stride + to[k]];
+                return;
+            case MATRIX_32:
+                for (int k = 0; k < count; k++)
+                    out[k] = data32[(size_t) from[k] * stride + to[k]];
+                return;
+            case TRIANGLE_16:
+                for (int k = 0; k < count; k++)
+                    out[k] = data16[packed_index(from[k], to[k])];
+                return;
+            case TRIANGLE_32:
+                for (int k = 0; k < count; k++)
+                    out[k] = data32[packed_index(from[k], to[k])];
+                return;
+            case TILE_CACHE:
+                for (int k = 0; k < count; k++)
+                    out[k] = cached_distance(from[k], to[k]);
+                return;
+            default:
+                for (int k = 0; k < count; k += 4)
+                    coordinate_distances4(from + k, to + k, out + k);
+                return;
+        }
+    }
+
+    inline void set(int city1, int city2, int weight) {
+        size_t index = (storage == TRIANGLE_16 || storage == TRIANGLE_32) ?
+                packed_index(city1, city2) :
+                (size_t) city1 * stride + city2;
+        if (width == 2)
+            data16[index] = (uint16_t) weight;
+        else
+            data32[index] = weight;
+    }
+
+private:
+    distance_storage storage;
+    int num_cities;
+    int width; // size of a matrix element in bytes, 2 or 4
+    size_t stride; // number of elements between two consecutive rows
+    uint16_t *data16;
+    int *data32;
+    double *x; // coordinates storage
+    double *y;
+    size_t *row_offset; // triangular storage: start of row i, minus i
+    // tile cache storage; the tiles are in 'data16' or 'data32', one slot
+    // after the other
+    bool ceiling_tiles; // CEIL_2D rounding of the cached distances
+    size_t tiles_per_side;
+    size_t set_mask; // number of sets - 1, a power of 2 minus 1
+    int set_shift; // 64 - log2(number of sets), at most 63
+    tile_set *tile_sets;
+    mutable long hits;
+    mutable long misses;
+    bool owner; // false if the matrix is mapped from a file
+
+    void release();
+    static void *aligned_block(size_t bytes);
+    size_t num_elements() const;
+    void set_row_offsets();
+    void fill_upper_rows(const double *x, const double *y, bool ceiling,
+            int begin, int end);
+    void mirror_upper_rows(int begin, int end);
+    size_t load_tile(uint32_t tag, size_t set) const;
+
+    inline int cached_distance(int city1, int city2) const {
+        // the tile (a, b) with a > b is the transpose of (b, a)
+        if ((city1 >> DISTANCE_TILE_SHIFT) > (city2 >> DISTANCE_TILE_SHIFT)) {
+            int swap = city1;
+            city1 = city2;
+            city2 = swap;
+        }
+        uint32_t tag = (uint32_t) (city1 >> DISTANCE_TILE_SHIFT) *
+                tiles_per_side + (city2 >> DISTANCE_TILE_SHIFT);
+        // Fibonacci hashing; the top bits of the product are well mixed
+        size_t set = (size_t) ((tag * 0x9E3779B97F4A7C15ull) >> set_shift) &
+                set_mask;
+        tile_set &ways = tile_sets[set];
+#if defined(__SSE2__)
+        __m128i key = _mm_set1_epi32((int) tag);
+        int found = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(key,
+                _mm_load_si128((const __m128i *) ways.tags)))) |
+                (_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(key,
+                _mm_load_si128((const __m128i *) (ways.tags + 4))))) << 4);
+        int way = found ? __builtin_ctz(found) : DISTANCE_CACHE_WAYS;
+#else
+        int way = 0;
+        while (way < DISTANCE_CACHE_WAYS && ways.tags[way] != tag)
+            way++;
+#endif
+        size_t slot;
+        if (way < DISTANCE_CACHE_WAYS) {
+            hits++;
+            ways.used |= 1 << way;
+            slot = set * DISTANCE_CACHE_WAYS + way;
+        } else {
+            misses++;
+            slot = load_tile(tag, set);
+        }
+        size_t index = slot * DISTANCE_TILE * DISTANCE_TILE +
+                ((city1 & (DISTANCE_TILE - 1)) << DISTANCE_TILE_SHIFT) +
+                (city2 & (DISTANCE_TILE - 1));
+        return width == 2 ? data16[index] : data32[index];
+    }
+
+    inline size_t packed_index(int city1, int city2) const {
+        int low = city1 < city2 ? city1 : city2;
+        int high = city1 < city2 ? city2 : city1;
+        return row_offset[low] + high;
+    }
+
+    inline double square_distance(int city1, int city2) const {
+        double xd = x[city1] - x[city2];
+        double yd = y[city1] - y[city2];
+        return xd * xd + yd * yd;
+    }
+
+    inline void coordinate_distances4(const int *from, const int *to,
+            int *out) const {
+#if defined(__AVX2__)
+        // the four edges in one register; sqrt is correctly rounded, so the
+        // results are identical to the scalar path
+        __m128i from4 = _mm_loadu_si128((const __m128i *) from);
+        __m128i to4 = _mm_loadu_si128((const __m128i *) to);
+        __m256d xd = _mm256_sub_pd(_mm256_i32gather_pd(x, from4, 8),
+                _mm256_i32gather_pd(x, to4, 8));
+        __m256d yd = _mm256_sub_pd(_mm256_i32gather_pd(y, from4, 8),
+                _mm256_i32gather_pd(y, to4, 8));
+        __m256d d = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(xd, xd),
+                _mm256_mul_pd(yd, yd)));
+        __m128i rounded;
+        if (storage == EUC_2D_COORDINATES)
+            rounded = _mm256_cvttpd_epi32(_mm256_add_pd(d,
+                    _mm256_set1_pd(0.5)));
+        else {
+            // ceil(d) = trunc(d) + (trunc(d) < d), as the distances are
+            // not negative
+            __m128i t = _mm256_cvttpd_epi32(d);
+            __m256d up = _mm256_and_pd(_mm256_cmp_pd(_mm256_cvtepi32_pd(t),
+                    d, _CMP_LT_OQ), _mm256_set1_pd(1.0));
+            rounded = _mm_add_epi32(t, _mm256_cvttpd_epi32(up));
+        }
+        _mm_storeu_si128((__m128i *) out, rounded);
+#elif defined(__SSE2__)
+        // sqrt is correctly rounded in SSE2, so the results are identical to
+        // the scalar path
+        __m128d xd0 = _mm_sub_pd(_mm_set_pd(x[from[1]], x[from[0]]),
+                _mm_set_pd(x[to[1]], x[to[0]]));
+        __m128d yd0 = _mm_sub_pd(_mm_set_pd(y[from[1]], y[from[0]]),
+                _mm_set_pd(y[to[1]], y[to[0]]));
+        __m128d xd1 = _mm_sub_pd(_mm_set_pd(x[from[3]], x[from[2]]),
+                _mm_set_pd(x[to[3]], x[to[2]]));
+        __m128d yd1 = _mm_sub_pd(_mm_set_pd(y[from[3]], y[from[2]]),
+                _mm_set_pd(y[to[3]], y[to[2]]));
+        __m128d d0 = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(xd0, xd0),
+                _mm_mul_pd(yd0, yd0)));
+        __m128d d1 = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(xd1, xd1),
+                _mm_mul_pd(yd1, yd1)));
+        __m128i rounded;
+        if (storage == EUC_2D_COORDINATES) {
+            __m128d half = _mm_set1_pd(0.5);
+            rounded = _mm_unpacklo_epi64(
+                    _mm_cvttpd_epi32(_mm_add_pd(d0, half)),
+                    _mm_cvttpd_epi32(_mm_add_pd(d1, half)));
+        } else {
+            // ceil(d) = trunc(d) + (trunc(d) < d), as the distances are
+            // not negative
+            __m128i t0 = _mm_cvttpd_epi32(d0);
+            __m128i t1 = _mm_cvttpd_epi32(d1);
+            __m128i up0 = _mm_castpd_si128(_mm_cmplt_pd(_mm_cvtepi32_pd(t0),
+                    d0));
+            __m128i up1 = _mm_castpd_si128(_mm_cmplt_pd(_mm_cvtepi32_pd(t1),
+                    d1));
+            // the compare masks are 64-bit lanes; keep their low halves
+            up0 = _mm_shuffle_epi32(up0, _MM_SHUFFLE(3, 3, 2, 0));
+            up1 = _mm_shuffle_epi32(up1, _MM_SHUFFLE(3, 3, 2, 0));
+            rounded = _mm_sub_epi32(_mm_unpacklo_epi64(t0, t1),
+                    _mm_unpacklo_epi64(up0, up1));
+        }
+        _mm_storeu_si128((__m128i *) out, rounded);
+#else
+        for (int k = 0; k < 4; k++)
+            out[k] = (*this)(from[k], to[k]);
+#endif
+    }
+};
+
+#endif /* DISTANCEMATRIX_H */
+
@@ -0,0 +1,112 @@
+/*
+ * File:    Islands.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: An island-model LAHC.
+ *
+ */
+
+#include "Islands.h"
+#include <thread>
+
+using namespace std;
+
+// the islands share the race for the `solution_quality` target only, as
+// `max_iteration` is the budget of each island
+static stopping_criteria race_criteria(stopping_criteria stop_criteria) {
+    stop_criteria.max_iteration = false;
+    return stop_criteria;
+}
+
+Islands::Islands(TSPLIB &tsp, stopping_criteria stop_criteria,
+        mutation_settings mutation, progress_settings progress, int lsize,
+        island_settings given_settings, uint64_t seed) :
+race(race_criteria(stop_criteria)),
+migration(given_settings.islands, tsp.properties.DIMENSION, given_settings.migration) {
+    settings = given_settings;
+    for (int i = 0; i < settings.islands; i++) {
+        islands.push_back(new LAHC(tsp, stop_criteria, mutation, progress,
+                lsize, RandomStream::derive(seed, i)));
+        islands[i]->set_race(&race);
+        if (settings.migration != NO_MIGRATION)
+            islands[i]->set_migration(&migration, i, settings.interval);
+    }
+}
+
+Islands::~Islands() {
+    for (size_t i = 0; i < islands.size(); i++)
+        delete islands[i];
+}
+
+void Islands::run() {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < settings.islands; i++)
+        threads.push_back(std::thread(&Islands::run_island, this, i));
+    for (int i = 0; i < settings.islands; i++)
+        threads[i].join();
+}
+
+void Islands::run_island(int index) {
+    islands[index]->run();
+    // its tours and list go, its best tour stays for the reports
+    islands[index]->release(true);
+}
+
+void Islands::cancel() {
+    race.end();
+}
+
+int Islands::best_island() {
+    int best = 0;
+    for (int i = 1; i < settings.islands; i++)
+        if (islands[i]->best_tour_size() < islands[best]->best_tour_size())
+            best = i;
+    return best;
+}
+
+string Islands::report_best_result() {
+    string msg = islands[best_island()]->report_best_result();
+    msg.erase(msg.rfind('\n') + 1); // the closing line goes last
+    msg += std::string(21, ' ') + ">> islands:            ";
+    msg += std::to_string(settings.islands) + ", best tour lengths";
+    long migrations = 0;
+    for (int i = 0; i < settings.islands; i++) {
+        msg += " " + std::to_string(islands[i]->best_tour_size());
+        migrations += islands[i]->num_migrations();
+    }
+    msg += "\n" + std::string(21, ' ') + ">> iterations:         ";
+    msg += std::to_string(num_iterations()) + "\n";
+    msg += std::string(21, ' ') + ">> migrations:         ";
+    msg += std::to_string(migrations) + "\n";
+    msg += std::string(21, ' ') + "--------------------------------------";
+    return msg;
+}
+
+void Islands::report_progress(ostream &progress, string run_num) {
+    islands[best_island()]->report_progress(progress, run_num);
+}
+
+void Islands::report_best_results(ostream &bests, string run_num) {
+    islands[best_island()]->report_best_results(bests, run_num);
+}
+
+void Islands::report_best_tour(ostream &tours, string run_num) {
+    islands[best_island()]->report_best_tour(tours, run_num);
+}
+
+void Islands::copy_results(vector<lahc_results> **collective_results,
+        int run) {
+    islands[best_island()]->copy_results(collective_results, run);
+}
+
+long Islands::num_iterations() {
+    long iterations = 0;
+    for (int i = 0; i < settings.islands; i++)
+        iterations += islands[i]->num_iterations();
+    return iterations;
+}
+
+int Islands::best_tour_size() {
+    return race.best_tour_length();
+}
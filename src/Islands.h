@@ -0,0 +1,55 @@
+/*
+ * File:    Islands.h
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: An island-model LAHC (`islands`): one LAHC chain per thread
+ * on the same instance, each with its own RandomStream derived from the
+ * 'seed' of the run. Unless `migration` is `none`, the chains exchange
+ * their best tours every `interval` iterations (see Migration.h). Every
+ * island stops on its own stopping criteria, and all of them stop once
+ * one reached the `solution_quality` (see Race.h), or when 'cancel' is
+ * called.
+ * The reports are those of the island with the best tour, but for the
+ * iterations, which are those of all the islands. Which island gets how
+ * far depends on the threads, so a run is not repeatable.
+ *
+ * Created on October 17, 2026
+ */
+
+#ifndef ISLANDS_H
+#define ISLANDS_H
+
+#include "LAHC.h"
+#include "Migration.h"
+#include "Race.h"
+#include <vector>
+
+using namespace std;
+
+class Islands {
+public:
+    Islands(TSPLIB &tsp, stopping_criteria stop_criteria,
+            mutation_settings mutation, progress_settings progress,
+            int lsize, island_settings settings, uint64_t seed);
+    ~Islands();
+    void run();
+    void cancel();
+    string report_best_result();
+    void report_progress(ostream &progress, string run_num);
+    void report_best_results(ostream &bests, string run_num);
+    void report_best_tour(ostream &tours, string run_num);
+    void copy_results(vector<lahc_results> **collective_results, int run);
+    long num_iterations();
+    int best_tour_size(); // of all the islands, also while they run
+private:
+    island_settings settings;
+    std::vector<LAHC*> islands;
+    Race race;
+    Migration migration;
+
+    void run_island(int index);
+    int best_island();
+};
+
+#endif /* ISLANDS_H */
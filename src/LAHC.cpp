@@ -11,47 +11,83 @@
 #include "LAHC.h"
 
 using namespace std;
-extern Random RANDOM; // random number generator
 
-LAHC::LAHC(TSPLIB &tsp, stopping_criteria stop_criteria, int lsize) {
+LAHC::LAHC(TSPLIB &tsp, stopping_criteria stop_criteria,
+        mutation_settings mutation, progress_settings progress_recorder,
+        int lsize, uint64_t seed) : random(seed) {
     stp_criteria = stop_criteria;
+    prog_settings = progress_recorder;
     list_size = lsize;
     num_cities = tsp.properties.DIMENSION;
     tsp_instance = &tsp;
     tour = new int[num_cities];
     best_tour = new int[num_cities];
     list = new int[list_size];
-    mut_conf.cuts = new int[2];
+    mut_conf.cuts = new int[4];
     mut_conf.num_cities = num_cities;
+    mut_conf.random = &random;
+    mut_conf.cut_pairs = &cut_pairs;
+    cut_pairs.init(num_cities, &random);
     list_indicator = 0;
     iteration = 0;
     idle_iteration = 0;
-    makeshuffle(num_cities, tour, num_cities); // permute a tour
+    accepted = 0;
+    progress.events = progress.last_iteration = 0;
+    progress.tolerance = 0;
+    checkpoint = NULL;
+    race = NULL;
+    migration = NULL;
+    migrant = NULL;
+    migrations = 0;
+    keeping_improvements = false;
+    resumed = false;
+    makeshuffle(num_cities, tour, num_cities, random); // permute a tour
+    tsp.to_internal_ids(tour); // same start whether renumbered or not
+    update_best_ever_tour();
+    initial_mutation(tsp, mutation);
     tour_length = best_tour_length = mut_conf.length = tsp.tour_length(tour);
     for (int i = 0; i < list_size; i++)
         list[i] = tour_length;
-    success_iteration_tour_length.push_back(best_tour_length);
+    initial_list_statistics();
 }
 
-LAHC::LAHC(TSPLIB &tsp, stopping_criteria stop_criteria, int lsize,
-        int *given_tour, std::vector<int> &history) {
+LAHC::LAHC(TSPLIB &tsp, stopping_criteria stop_criteria,
+        mutation_settings mutation, progress_settings progress_recorder,
+        int lsize, uint64_t seed, int *given_tour,
+        const SeedHistory &history) : random(seed) {
     stp_criteria = stop_criteria;
+    prog_settings = progress_recorder;
     list_size = lsize;
     num_cities = tsp.properties.DIMENSION;
     tsp_instance = &tsp;
     tour = new int[num_cities];
     best_tour = new int[num_cities];
     list = new int[list_size];
-    mut_conf.cuts = new int[2];
+    mut_conf.cuts = new int[4];
     mut_conf.num_cities = num_cities;
+    mut_conf.random = &random;
+    mut_conf.cut_pairs = &cut_pairs;
+    cut_pairs.init(num_cities, &random);
     list_indicator = 0;
     iteration = 0;
     idle_iteration = 0;
+    accepted = 0;
+    progress.events = progress.last_iteration = 0;
+    progress.tolerance = 0;
+    checkpoint = NULL;
+    race = NULL;
+    migration = NULL;
+    migrant = NULL;
+    migrations = 0;
+    keeping_improvements = false;
+    resumed = false;
     for (int i = 0; i < num_cities; i++)
         tour[i] = given_tour[i];
+    update_best_ever_tour();
+    initial_mutation(tsp, mutation);
     tour_length = best_tour_length = mut_conf.length = tsp.tour_length(tour);
     initial_list(history);
-    success_iteration_tour_length.push_back(best_tour_length);
+    initial_list_statistics();
 }
 
 LAHC::~LAHC() {
@@ -59,19 +95,262 @@ LAHC::~LAHC() {
     delete [] best_tour;
     delete [] list;
     delete [] mut_conf.cuts;
+    delete [] position;
+    delete [] migrant;
 
-    success_iteration_tour_length.resize(0);
-    success_iteration_tour_length.clear();
-    success_iteration_tour_length.shrink_to_fit();
     results.resize(0);
     results.clear();
     results.shrink_to_fit();
 }
 
+void LAHC::release(bool keep_best_tour) {
+    delete [] tour;
+    delete [] list;
+    delete [] position;
+    delete [] migrant;
+    tour = list = position = migrant = NULL;
+    if (!keep_best_tour) {
+        delete [] best_tour;
+        best_tour = NULL;
+    }
+    improvements.clear();
+    results.shrink_to_fit();
+}
+
+void LAHC::set_checkpoint(Checkpoint *given_checkpoint) {
+    checkpoint = given_checkpoint;
+}
+
+void LAHC::set_race(Race *given_race) {
+    race = given_race;
+}
+
+void LAHC::set_migration(Migration *given_migration, int given_island,
+        long interval) {
+    migration = given_migration;
+    island = given_island;
+    migration_interval = interval;
+    published_length = INT_MAX;
+    delete [] migrant;
+    migrant = new int[num_cities];
+    // the list is seeded from at most its size of the smallest lengths,
+    // which the history keeps exactly with twice that capacity
+    keep_improvements(2 * list_size);
+}
+
+void LAHC::keep_improvements(int capacity) {
+    keeping_improvements = true;
+    improvements.init(capacity);
+    improvements.add(best_tour_length);
+}
+
+const SeedHistory &LAHC::improvement_history() {
+    return improvements;
+}
+
+void LAHC::save_state(CheckpointOut &out) const {
+    out.put(stp_criteria);
+    out.put(list_size);
+    out.put(list_indicator);
+    out.put(iteration);
+    out.put(idle_iteration);
+    out.put(accepted);
+    out.put(tour_length);
+    out.put(best_tour_length);
+    out.put(list_sum);
+    out.put(list_min);
+    out.put(list_min_count);
+    out.put(progress);
+    out.put(random);
+    cut_pairs.save(out);
+    selector.save(out);
+    out.put_buffer(tour, num_cities);
+    out.put_buffer(best_tour, num_cities);
+    out.put_buffer(list, list_size);
+    out.put_vector(results);
+    out.put(keeping_improvements);
+    improvements.save(out);
+}
+
+void LAHC::load_state(CheckpointIn &in) {
+    in.get(stp_criteria);
+    in.get(list_size);
+    in.get(list_indicator);
+    in.get(iteration);
+    in.get(idle_iteration);
+    in.get(accepted);
+    in.get(tour_length);
+    in.get(best_tour_length);
+    in.get(list_sum);
+    in.get(list_min);
+    in.get(list_min_count);
+    in.get(progress);
+    in.get(random);
+    cut_pairs.load(in);
+    selector.load(in);
+    delete [] tour;
+    delete [] best_tour;
+    delete [] list;
+    tour = in.get_buffer<int>(num_cities);
+    best_tour = in.get_buffer<int>(num_cities);
+    list = in.get_buffer<int>(list_size);
+    in.get_vector(results);
+    in.get(keeping_improvements);
+    improvements.load(in);
+    if (position != NULL) {
+        if (tour != NULL)
+            for (int i = 0; i < num_cities; i++)
+                position[tour[i]] = i;
+        else {
+            delete [] position;
+            mut_conf.position = position = NULL;
+        }
+    }
+    mut_conf.length = tour_length;
+    resumed = true;
+}
+
 void LAHC::run() {
-    push_improvement();
-    while (stop()) {
-        mutation_cost();
+    // the proposal and the stopping criteria are fixed for the whole run,
+    // so they select the instantiation of 'run_loop' once, here
+    const DistanceMatrix *distances = &tsp_instance->distance_matrix;
+    if (mut_settings.policy != FIXED_POLICY) {
+        adaptive_move move = {distances, &selector};
+        run_with(move);
+        selector.finish();
+    } else if (mut_settings.two_level_list) {
+        // the tour is in 'two_level' during the run, and back in 'tour'
+        // at the end of it
+        TwoLevelList two_level;
+        two_level.init(num_cities, tour);
+        if (mut_settings.proposal == NEIGHBOUR_PROPOSAL) {
+            list_neighbour_2opt_move move = {distances, neighbours,
+                &two_level};
+            run_with(move);
+        } else {
+            list_2opt_move move = {distances, &two_level};
+            run_with(move);
+        }
+        two_level.to_array(tour);
+    } else if (mut_settings.proposal == NEIGHBOUR_PROPOSAL) {
+        neighbour_2opt_move move = {distances, neighbours};
+        run_with(move);
+    } else if (mut_settings.proposal == OR_OPT_PROPOSAL) {
+        or_opt_move move = {distances};
+        run_with(move);
+    } else if (mut_settings.proposal == MIXED_PROPOSAL) {
+        mixed_move move = {distances};
+        run_with(move);
+    } else if (mut_settings.batch_size > 1) {
+        move_batch batch;
+        batch.size = batch.next = 0;
+        batch.length = 1;
+        batch.max_length = mut_settings.batch_size;
+        batched_2opt_move move = {distances, &batch};
+        run_with(move);
+    } else {
+        uniform_2opt_move move = {distances};
+        run_with(move);
+    }
+}
+
+template <class Move>
+void LAHC::run_with(const Move &move) {
+    SeedHistory *kept_improvements = keeping_improvements ? &improvements :
+            NULL;
+    if (prog_settings.recorder == LOG_RECORDER) {
+        log_recorder recorder = {&results, kept_improvements,
+            &progress, double(prog_settings.buckets)};
+        run_recording(move, recorder);
+    } else if (prog_settings.recorder == RESERVOIR_RECORDER) {
+        reservoir_recorder recorder = {&results, kept_improvements,
+            &progress,
+            size_t(prog_settings.capacity)};
+        run_recording(move, recorder);
+    } else {
+        improvement_recorder recorder = {&results, kept_improvements,
+            &progress};
+        run_recording(move, recorder);
+    }
+}
+
+template <class Move, class Recorder>
+void LAHC::run_recording(const Move &move, const Recorder &recorder) {
+    long limit = stp_criteria.max_iteration ? stp_criteria.max_iteration_par :
+            LONG_MAX;
+    if (stp_criteria.list_convergence) {
+        list_convergence_stop stop = {limit,
+            stp_criteria.list_convergence_par,
+            stp_criteria.solution_quality ?
+            stp_criteria.solution_quality_par : -1.};
+        run_loop(move, stop, recorder);
+    } else if (stp_criteria.point_of_convergence &&
+            stp_criteria.solution_quality) {
+        convergence_quality_stop stop = {limit,
+            stp_criteria.point_of_convergence_par,
+            stp_criteria.solution_quality_par};
+        run_loop(move, stop, recorder);
+    } else if (stp_criteria.point_of_convergence) {
+        convergence_stop stop = {limit, stp_criteria.point_of_convergence_par};
+        run_loop(move, stop, recorder);
+    } else if (stp_criteria.max_iteration) {
+        iteration_limit_stop stop = {limit};
+        run_loop(move, stop, recorder);
+    } else
+        error("The `stopping_criterion` is not implemented --> LAHC::run()");
+}
+
+template <class Move, class Stop, class Recorder>
+void LAHC::run_loop(const Move &move, const Stop &stop,
+        const Recorder &recorder) {
+    // a new best tour is saved only when an accepted move is about to leave
+    // it, or at the end of the run: while the tour keeps improving, nothing
+    // is copied
+    bool best_is_current = false;
+    // the race and the clock are only looked at every 'poll_interval'
+    // iterations
+    long poll_interval = race != NULL ? RACE_POLL : CHECKPOINT_POLL;
+    if (migration != NULL)
+        poll_interval = std::min(poll_interval, migration_interval);
+    long poll_iteration = race != NULL || migration != NULL ||
+            (checkpoint != NULL && checkpoint->enabled()) ?
+            iteration + poll_interval : LONG_MAX;
+    long raced_iteration = iteration; // the iterations reported to 'race'
+    long migration_iteration = iteration + migration_interval;
+    if (!resumed)
+        recorder.record(iteration, best_tour_length, list_average());
+    resumed = false;
+    while (stop.proceed(iteration, idle_iteration, best_tour_length,
+            list_min_count == list_size)) {
+        if (iteration >= poll_iteration) {
+            poll_iteration = iteration + poll_interval;
+            if (race != NULL) {
+                bool proceed = race->proceed(iteration - raced_iteration,
+                        best_tour_length);
+                raced_iteration = iteration;
+                if (!proceed)
+                    break;
+            }
+            if (migration != NULL && iteration >= migration_iteration) {
+                migration_iteration = iteration + migration_interval;
+                if (best_is_current) {
+                    move.save(tour, best_tour, num_cities);
+                    best_is_current = false;
+                }
+                if (migrate())
+                    recorder.improved(iteration, best_tour_length,
+                        list_average());
+            }
+            if (checkpoint != NULL && checkpoint->due()) {
+                if (best_is_current) {
+                    move.save(tour, best_tour, num_cities);
+                    best_is_current = false;
+                }
+                checkpoint->write();
+            }
+        }
+        mut_conf.length = tour_length;
+        move.propose(tour, &mut_conf);
         if (mut_conf.length >= tour_length)
             idle_iteration++;
         else
@@ -79,28 +358,78 @@ void LAHC::run() {
         list_indicator = iteration % list_size;
         if (mut_conf.length < list[list_indicator] ||
                 mut_conf.length <= tour_length) {
-            update_tour(tour, &mut_conf);
+            if (best_is_current && mut_conf.length >= best_tour_length) {
+                move.save(tour, best_tour, num_cities);
+                best_is_current = false;
+            }
+            move.apply(tour, &mut_conf);
             tour_length = mut_conf.length;
+            accepted++;
         }
         if (tour_length < list[list_indicator])
-            list[list_indicator] = tour_length;
+            lower_list_entry(tour_length);
         if (tour_length < best_tour_length) {
             best_tour_length = mut_conf.length;
-            success_iteration_tour_length.push_back(best_tour_length);
-            update_best_ever_tour();
-            push_improvement();
+            best_is_current = true;
+            recorder.improved(iteration, best_tour_length, list_average());
         }
         iteration++;
     }
-    if (results[results.size() - 1].iteration != iteration - 1)
-        push_improvement(); // to restore the last stage
+    if (best_is_current)
+        move.save(tour, best_tour, num_cities);
+    move.saved(best_tour);
+    if (race != NULL)
+        race->proceed(iteration - raced_iteration, best_tour_length);
+    if (progress.last_iteration != iteration - 1)
+        recorder.record(iteration, best_tour_length, list_average());
 }
 
-void LAHC::initial_list(std::vector<int>& history) {
-    for (int i = 0; i < list_size; i++)
-        list[i] = history[i % history.size()];
-    // Now we sort the list
-    sort(list, list + list_size, std::greater<int>());
+void LAHC::initial_mutation(TSPLIB &tsp, mutation_settings mutation) {
+    mut_settings = mutation;
+    selector.init(mut_settings.policy == BANDIT_POLICY, &random);
+    neighbours = NULL;
+    position = NULL;
+    if (mut_settings.proposal == NEIGHBOUR_PROPOSAL) {
+        neighbours = &tsp.neighbour_lists(mut_settings.num_neighbours);
+        if (!mut_settings.two_level_list) {
+            position = new int[num_cities];
+            for (int i = 0; i < num_cities; i++)
+                position[tour[i]] = i;
+        }
+        mut_conf.num_neighbours = std::min(mut_settings.num_neighbours,
+                neighbours->size());
+    }
+    mut_conf.position = position;
+}
+
+void LAHC::initial_list(const SeedHistory &history) {
+    // the shortest lengths of the history, in descending order
+    history.seed(list, list_size);
+}
+
+bool LAHC::migrate() {
+    if (best_tour_length < published_length) {
+        migration->publish(island, best_tour, best_tour_length);
+        published_length = best_tour_length;
+    }
+    int length = migration->receive(island, migrant, best_tour_length);
+    if (length < 0)
+        return false;
+    std::swap(tour, migrant);
+    std::copy(tour, tour + num_cities, best_tour);
+    tour_length = best_tour_length = length;
+    if (position != NULL)
+        for (int i = 0; i < num_cities; i++)
+            position[tour[i]] = i;
+    // the list goes on from the received tour as a new list of pLAHC-s
+    // does from the best tour, seeded from the improvements so far
+    improvements.add(length);
+    improvements.flush();
+    initial_list(improvements);
+    initial_list_statistics();
+    idle_iteration = 0;
+    migrations++;
+    return true;
 }
 
 void LAHC::permutate() {
@@ -112,10 +441,12 @@ void LAHC::permutate() {
             idle_iteration = 0;
         update_tour(tour, &mut_conf);
         tour_length = mut_conf.length;
+        accepted++;
     }
-    list[list_indicator] = tour_length;
+    set_list_entry(tour_length);
     if (mut_conf.length < best_tour_length) {
         best_tour_length = mut_conf.length;
+        update_best_ever_tour();
         push_improvement();
     }
     list_indicator = iteration % list_size;
@@ -130,7 +461,17 @@ inline void LAHC::mutation_cost() {
     //    swapping
     //    replacement
     mut_conf.length = tour_length;
-    //    int selected_mutation = RANDOM.uniform((long) 0, (long) 2);
+    if (mut_settings.proposal == NEIGHBOUR_PROPOSAL) {
+        neighbour_2opt(tour, &mut_conf, tsp_instance->distance_matrix,
+                *neighbours);
+        return;
+    }
+    if (mut_settings.proposal == OR_OPT_PROPOSAL ||
+            (mut_settings.proposal == MIXED_PROPOSAL && random.flip(0.5))) {
+        or_opt(tour, &mut_conf, tsp_instance->distance_matrix);
+        return;
+    }
+    //    int selected_mutation = random.uniform((long) 0, (long) 2);
     // here we only use 'double_bridge' as it is implemented in
     // 2017 version of Burke and Bykov
     int selected_mutation = 0; 
@@ -156,36 +497,40 @@ int *LAHC::current_tour() {
 }
 
 double LAHC::list_average() {
-    double avg_list = 0.0;
-    for (int i = 0; i < list_size; i++)
-        avg_list += list[i];
-    return avg_list / (double) list_size;
+    return list_sum / (double) list_size;
 }
 
 bool LAHC::list_converge() {
-    for (int i = 1; i < list_size; i++)
-        if (list[0] != list[i])
-            return false;
-    return true;
+    // all the entries are the minimum
+    return list_min_count == list_size;
 }
 
-inline bool LAHC::stop() {
-    if (stp_criteria.max_iteration){
-        return stp_criteria.max_iteration_par > iteration; 
-    }
-    else if (stp_criteria.point_of_convergence && stp_criteria.solution_quality)
-        return ((iteration < 100000 || idle_iteration *
-            stp_criteria.point_of_convergence_par < iteration) &&
-            (best_tour_length > stp_criteria.solution_quality_par));
-    else if (stp_criteria.point_of_convergence &&
-            not stp_criteria.solution_quality){
-        return (iteration < 100000 || idle_iteration *
-            stp_criteria.point_of_convergence_par < iteration);        
+void LAHC::initial_list_statistics() {
+    list_sum = 0;
+    list_min = list[0];
+    list_min_count = 0;
+    for (int i = 0; i < list_size; i++) {
+        list_sum += list[i];
+        if (list[i] < list_min) {
+            list_min = list[i];
+            list_min_count = 0;
+        }
+        if (list[i] == list_min)
+            list_min_count++;
     }
-    else
-        error("The `stopping_criterion` is not implemented --> LAHC::stop()");
+}
 
-    return false;
+void LAHC::set_list_entry(int value) {
+    int old = list[list_indicator];
+    if (value < old) {
+        lower_list_entry(value);
+        return;
+    }
+    list_sum += value - old;
+    list[list_indicator] = value;
+    // raising the last entry at the minimum makes another entry the minimum
+    if (value > old && old == list_min && --list_min_count == 0)
+        initial_list_statistics();
 }
 
 inline void LAHC::push_improvement() {
@@ -193,6 +538,8 @@ inline void LAHC::push_improvement() {
     improvement.best_tour_length = best_tour_length;
     improvement.iteration = iteration;
     improvement.list_avg = list_average();
+    improvement.event = progress.events++;
+    progress.last_iteration = iteration;
     results.push_back(improvement);
 }
 
@@ -209,14 +556,21 @@ string LAHC::report_best_result() {
     msg += std::to_string(results[results.size() - 1].best_tour_length) + "\n";
     msg += std::string(21, ' ') + ">> list avg.:          ";
     msg += std::to_string(results[results.size() - 1].list_avg) + "\n";
+    msg += std::string(21, ' ') + ">> acceptance rate:    ";
+    msg += std::to_string(accepted / (double) std::max(iteration, 1L)) + "\n";
+    if (prog_settings.recorder == RESERVOIR_RECORDER) {
+        msg += std::string(21, ' ') + ">> progress tolerance: ";
+        msg += std::to_string(progress.tolerance) + "\n";
+    }
+    if (mut_settings.policy != FIXED_POLICY)
+        msg += selector.report();
     msg += std::string(21, ' ') + "--------------------------------------";
 
     return msg;
 }
 
-void LAHC::report_progress(string prog_file, string run_num) {
-    // it will store the progress in a file with name <output>.progress
-    ofstream progress(prog_file.c_str(), ios_base::app);
+void LAHC::report_progress(ostream &progress, string run_num) {
+    // it will write the progress for the file with name <output>.progress
     progress << "## Run number " << run_num << endl;
 
     for (long i = 0; i < results.size(); i++)
@@ -224,18 +578,24 @@ void LAHC::report_progress(string prog_file, string run_num) {
         ", " << std::to_string(results[i].best_tour_length) << ", " <<
         std::to_string(results[i].list_avg) << ") ";
     progress << endl;
-    progress.close();
 }
 
-void LAHC::report_best_results(string best_results_file, string run_num) {
-    // it will store best results obtained in each run in a file 
+void LAHC::report_best_results(ostream &bests, string run_num) {
+    // it will write the best results of the run for the file
     // with name <output>.bests
 
-    ofstream bests(best_results_file.c_str(), ios_base::app);
     bests << run_num << " " << std::to_string(iteration) << " " <<
             std::to_string(best_tour_length) << " " <<
             std::to_string(list_average()) << endl;
-    bests.close();
+}
+
+void LAHC::report_best_tour(ostream &tours, string run_num) {
+    // it will write the best tour of the run for the file with name
+    // <output>.tour, with the city ids of the instance file (1-based)
+    tours << run_num << " " << std::to_string(best_tour_length) << endl;
+    for (int i = 0; i < num_cities; i++)
+        tours << tsp_instance->original_city(best_tour[i]) + 1 <<
+            (i + 1 < num_cities ? " " : "\n");
 }
 
 void LAHC::sum_results_comp(vector<lahc_results> &sum_res) {
@@ -302,6 +662,22 @@ long LAHC::num_iterations() {
     return iteration;
 }
 
+long LAHC::num_accepted() {
+    return accepted;
+}
+
+long LAHC::num_records() {
+    return progress.events;
+}
+
+long LAHC::num_migrations() {
+    return migrations;
+}
+
+int LAHC::progress_tolerance() {
+    return progress.tolerance;
+}
+
 int LAHC::list_val(int index) {
     return list[index];
 }
@@ -313,3 +689,7 @@ int LAHC::current_tour_length() {
 int LAHC::best_tour_size() {
     return best_tour_length;
 }
+
+const OperatorSelector &LAHC::operator_selector() {
+    return selector;
+}
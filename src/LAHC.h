@@ -5,6 +5,34 @@
  *
  * Description: The LAHC class implements the LAHC introduced by Bruke and 
  * Bykov (2017).
+ * The main loop ('run_loop') is a template over the move, the stopping
+ * criteria and the progress recorder (see LAHC_policies.h); 'run' picks
+ * the instantiation once per run. With 'tour_representation: two_level'
+ * the moves work on a TwoLevelList built from the tour at the start of
+ * the run.
+ * Every LAHC draws its random numbers from its own RandomStream, set by
+ * the 'seed' key given to the constructor.
+ * The sum of the list and the number of its entries at the minimum are
+ * kept as the entries change, so 'list_average' and 'list_converge' are
+ * O(1), and the stopping criteria can ask for convergence every iteration.
+ * 'results' holds the records kept by the recorder of `progress_recorder`;
+ * their 'event' is their index among all the records of the run, and
+ * 'num_records' is how many records were made.
+ * With 'keep_improvements', the lengths of the start tour and of every
+ * improvement are kept in 'improvement_history', for the lists that seed
+ * from them (pLAHC-s and the islands); other lists do not keep them.
+ * Once a run is over, 'release' frees its tours and its list; what the
+ * reports read (the records, the counters, the list average and the
+ * operator statistics) stays.
+ * With 'set_checkpoint', the loop writes a checkpoint when it is due;
+ * 'save_state' and 'load_state' hold all a run needs to go on from there
+ * as if it had never stopped.
+ * With 'set_race', the list reports to the Race of a parallel pLAHC, and
+ * stops once the race is over.
+ * With 'set_migration', the list is an island: every 'interval'
+ * iterations it publishes its best tour, and takes the tour it receives
+ * if it is shorter, seeding its list from its improvements and that tour
+ * as pLAHC-s seeds a new list from its history.
  * 
  * Created on March 31, 2016, 3:34 PM
  */
@@ -14,9 +42,16 @@
 
 #include "TSPLIB.h"
 #include "TSP_mutation.h"
+#include "LAHC_policies.h"
+#include "TwoLevelList.h"
+#include "OperatorSelector.h"
+#include "SeedHistory.h"
 #include "Util.h"
 #include "Configuration.h"
-#include "Random.h"
+#include "RandomStream.h"
+#include "Checkpoint.h"
+#include "Race.h"
+#include "Migration.h"
 #include <iostream>
 #include <vector>
 #include <stdlib.h> 
@@ -28,47 +63,108 @@ using namespace std;
 class LAHC {
 public:
     std::vector <lahc_results> results;
-    std::vector<int> success_iteration_tour_length;
-    LAHC(TSPLIB &tsp, stopping_criteria stop_criteria, int lsize);
-    LAHC(TSPLIB &tsp, stopping_criteria stop_criteria, int lsize,
-            int *given_tour, std::vector<int> &history); 
+    LAHC(TSPLIB &tsp, stopping_criteria stop_criteria,
+            mutation_settings mutation, progress_settings progress,
+            int lsize, uint64_t seed);
+    LAHC(TSPLIB &tsp, stopping_criteria stop_criteria,
+            mutation_settings mutation, progress_settings progress,
+            int lsize, uint64_t seed, int *given_tour,
+            const SeedHistory &history);
     ~LAHC();
     void run();
+    void release(bool keep_best_tour);
+    void set_checkpoint(Checkpoint *checkpoint);
+    void set_race(Race *race);
+    void set_migration(Migration *migration, int island, long interval);
+    void keep_improvements(int capacity);
+    const SeedHistory &improvement_history();
+    void save_state(CheckpointOut &out) const;
+    void load_state(CheckpointIn &in);
     int *best_ever_tour();
     int *current_tour();
     string report_best_result();
-    void report_progress(string prog_file, string run_num);
-    void report_best_results(string best_results_file, string run_num);
+    void report_progress(ostream &progress, string run_num);
+    void report_best_results(ostream &bests, string run_num);
+    void report_best_tour(ostream &tours, string run_num);
     void sum_results_comp(vector<lahc_results> &sum_res);
     void copy_results(vector<lahc_results> **collective_results, int run);
     double list_average();
     bool list_converge();
     long num_iterations();
+    long num_accepted();
+    long num_records();
+    long num_migrations();
+    int progress_tolerance();
     int best_tour_size();
+    const OperatorSelector &operator_selector();
     void permutate();
     int list_val(int index);
     int current_tour_length();
 private:
     TSPLIB *tsp_instance;
+    RandomStream random; // the stream of the run, from its 'seed'
+    CutPairs cut_pairs; // of the 2-opt moves, from 'random'
     stopping_criteria stp_criteria;
     tsp_mut_properties mut_conf;
+    mutation_settings mut_settings;
+    progress_settings prog_settings;
+    progress_state progress; // of the kept 'results'
+    const NeighbourLists *neighbours;
+    OperatorSelector selector; // for `mutation_policy` random and bandit
     int *tour;
+    int *position; // position of each city in 'tour', for neighbour_2opt
     int *best_tour;
     int tour_length;
     int num_cities;
     int list_size;
     int *list;
     int list_indicator;
+    long list_sum; // of the entries of 'list'
+    int list_min; // the smallest entry of 'list'
+    int list_min_count; // entries of 'list' equal to 'list_min'
     long iteration;
     long idle_iteration;
+    long accepted;
     int best_tour_length;
     lahc_results improvement;
+    SeedHistory improvements; // lengths of the improvements, if kept
+    bool keeping_improvements;
+    Checkpoint *checkpoint; // NULL for none
+    Race *race; // of the lists of a parallel pLAHC, NULL for none
+    Migration *migration; // of the islands, NULL for none
+    int island; // the slot of the list in 'migration'
+    long migration_interval;
+    int *migrant; // the tour received from another island
+    int published_length; // of the last best tour published
+    long migrations; // received tours taken
+    bool resumed; // from a checkpoint, so the run is already started
 
     inline void mutation_cost();
-    inline bool stop();
+    template <class Move> void run_with(const Move &move);
+    template <class Move, class Recorder>
+    void run_recording(const Move &move, const Recorder &recorder);
+    template <class Move, class Stop, class Recorder>
+    void run_loop(const Move &move, const Stop &stop,
+            const Recorder &recorder);
     inline void push_improvement();
     inline void update_best_ever_tour();
-    void initial_list(std::vector<int> &history);
+    void initial_list(const SeedHistory &history);
+    bool migrate();
+    void initial_list_statistics();
+    void set_list_entry(int value);
+
+    // list[list_indicator] is lowered to 'value', which keeps the sum and
+    // the minimum of the list in O(1)
+    inline void lower_list_entry(int value) {
+        list_sum += value - list[list_indicator];
+        list[list_indicator] = value;
+        if (value < list_min) {
+            list_min = value;
+            list_min_count = 1;
+        } else if (value == list_min)
+            list_min_count++;
+    }
+    void initial_mutation(TSPLIB &tsp, mutation_settings mutation);
 };
 
 #endif /* LAHC_H */
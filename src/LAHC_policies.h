@@ -0,0 +1,439 @@
+/*
+ * File:    LAHC_policies.h
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: Policies of the main loop of LAHC ('LAHC::run_loop'). The
+ * loop is a template over three of them, and 'LAHC::run' picks the
+ * instantiation once from the configuration, so that no proposal type or
+ * stopping criterion is looked up in the loop itself:
+ *      - move: proposes a move and sets its cost ('propose'), applies it
+ *        to the tour when it is accepted ('apply'), keeps the tour as the
+ *        best one before it is left ('save'), and writes that tour at the
+ *        end of the run ('saved'). The moves on the tour array share these
+ *        two ('array_tour_move'). The list moves work on a TwoLevelList,
+ *        which keeps a tour without copying it, and leave the tour array
+ *        as it was,
+ *      - stopping: true while the run should go on ('proceed'). A
+ *        'max_iteration' criterion is folded in as 'limit' (LONG_MAX if it
+ *        is not set), so it costs one comparison,
+ *      - recorder: told about every new best tour ('improved'), and about
+ *        the state at the start and at the end of the run ('record'). It
+ *        picks which of them are kept, from `progress_recorder`: `log`
+ *        and `reservoir` bound the records of a run. The lengths of the
+ *        improvements go to 'improvements' only for the lists that seed
+ *        from them (pLAHC-s and the islands), which bounds them by its
+ *        capacity; it is NULL for the others.
+ *
+ * Created on October 17, 2026
+ */
+
+#ifndef LAHC_POLICIES_H
+#define LAHC_POLICIES_H
+
+#include "TSP_mutation.h"
+#include "DistanceMatrix.h"
+#include "NeighbourLists.h"
+#include "TwoLevelList.h"
+#include "OperatorSelector.h"
+#include "SeedHistory.h"
+#include "Util.h"
+#include <climits>
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+// the moves on the tour array: the best tour is a copy of the tour, made
+// when the tour is about to leave it, and is already in place at the end
+struct array_tour_move {
+    inline void save(const int *tour, int *copy, int num_cities) const {
+        std::copy(tour, tour + num_cities, copy);
+    }
+
+    inline void saved(int *) const {
+    }
+};
+
+// 'double_bridge': a reversal between two uniform random cuts
+struct uniform_2opt_move : array_tour_move {
+    const DistanceMatrix *distances;
+
+    uniform_2opt_move(const DistanceMatrix *given_distances) :
+    distances(given_distances) {
+    }
+
+    inline void propose(int *tour, tsp_mut_properties *mut_conf) const {
+        double_bridge(tour, mut_conf, *distances);
+    }
+
+    inline void apply(int *tour, tsp_mut_properties *mut_conf) const {
+        reverse_segment(tour, mut_conf);
+    }
+};
+
+// the moves that 'batched_2opt_move' has drawn and evaluated ahead
+struct move_batch {
+    int cuts[2 * MAX_MOVE_BATCH];
+    int deltas[MAX_MOVE_BATCH];
+    int size; // moves in the batch
+    int next; // the next move to propose
+    int length; // moves in the next batch
+    int max_length; // 'batch_size'
+};
+
+// 'double_bridge', drawn and evaluated 'batch->length' moves at a time
+// ('double_bridge_batch'). The moves are proposed in the order they were
+// drawn. They do not depend on the tour, so they stay valid until one is
+// accepted; the rest of the batch is then dropped, which is the same as
+// drawing it again. The run sees the same distribution of moves as with
+// 'uniform_2opt_move'. The next batch is twice as long after a batch
+// without an accepted move, and one move long after an accepted one, so
+// that few moves are dropped while most moves are accepted.
+struct batched_2opt_move : array_tour_move {
+    const DistanceMatrix *distances;
+    move_batch *batch;
+
+    batched_2opt_move(const DistanceMatrix *given_distances,
+            move_batch *given_batch) :
+    distances(given_distances), batch(given_batch) {
+    }
+
+    inline void propose(int *tour, tsp_mut_properties *mut_conf) const {
+        if (batch->next == batch->size) {
+            batch->size = batch->length;
+            batch->next = 0;
+            double_bridge_batch(tour, mut_conf->num_cities, *distances,
+                    batch->size, batch->cuts, batch->deltas,
+                    *mut_conf->cut_pairs);
+            batch->length = std::min(2 * batch->length, batch->max_length);
+        }
+        int k = batch->next++;
+        mut_conf->mutation_type = DOUBLE_BRIDGE_MUTATION;
+        mut_conf->cuts[0] = batch->cuts[2 * k];
+        mut_conf->cuts[1] = batch->cuts[2 * k + 1];
+        mut_conf->length += batch->deltas[k];
+    }
+
+    inline void apply(int *tour, tsp_mut_properties *mut_conf) const {
+        reverse_segment(tour, mut_conf);
+        batch->next = batch->size;
+        batch->length = 1;
+    }
+};
+
+// 'neighbour_2opt': a reversal that adds an edge to a near neighbour
+struct neighbour_2opt_move : array_tour_move {
+    const DistanceMatrix *distances;
+    const NeighbourLists *neighbours;
+
+    neighbour_2opt_move(const DistanceMatrix *given_distances,
+            const NeighbourLists *given_neighbours) :
+    distances(given_distances), neighbours(given_neighbours) {
+    }
+
+    inline void propose(int *tour, tsp_mut_properties *mut_conf) const {
+        neighbour_2opt(tour, mut_conf, *distances, *neighbours);
+    }
+
+    inline void apply(int *tour, tsp_mut_properties *mut_conf) const {
+        reverse_segment(tour, mut_conf);
+    }
+};
+
+// 'or_opt': a segment of 1 to OR_OPT_MAX_SEGMENT cities is moved
+struct or_opt_move : array_tour_move {
+    const DistanceMatrix *distances;
+
+    or_opt_move(const DistanceMatrix *given_distances) :
+    distances(given_distances) {
+    }
+
+    inline void propose(int *tour, tsp_mut_properties *mut_conf) const {
+        or_opt(tour, mut_conf, *distances);
+    }
+
+    inline void apply(int *tour, tsp_mut_properties *mut_conf) const {
+        move_segment(tour, mut_conf);
+    }
+};
+
+// 'double_bridge' or 'or_opt', with equal probability
+struct mixed_move : array_tour_move {
+    const DistanceMatrix *distances;
+
+    mixed_move(const DistanceMatrix *given_distances) :
+    distances(given_distances) {
+    }
+
+    inline void propose(int *tour, tsp_mut_properties *mut_conf) const {
+        if (mut_conf->random->flip(0.5))
+            or_opt(tour, mut_conf, *distances);
+        else
+            double_bridge(tour, mut_conf, *distances);
+    }
+
+    inline void apply(int *tour, tsp_mut_properties *mut_conf) const {
+        if (mut_conf->mutation_type == OR_OPT_MUTATION)
+            move_segment(tour, mut_conf);
+        else
+            reverse_segment(tour, mut_conf);
+    }
+};
+
+// 'list_2opt': 'double_bridge' on a TwoLevelList
+struct list_2opt_move {
+    const DistanceMatrix *distances;
+    TwoLevelList *list;
+
+    inline void propose(int *, tsp_mut_properties *mut_conf) const {
+        list_2opt(*list, mut_conf, *distances);
+    }
+
+    inline void apply(int *, tsp_mut_properties *mut_conf) const {
+        flip_segment(*list, mut_conf);
+    }
+
+    inline void save(const int *, int *, int) const {
+        list->save();
+    }
+
+    inline void saved(int *copy) const {
+        list->saved_tour(copy);
+    }
+};
+
+// 'list_neighbour_2opt': 'neighbour_2opt' on a TwoLevelList
+struct list_neighbour_2opt_move {
+    const DistanceMatrix *distances;
+    const NeighbourLists *neighbours;
+    TwoLevelList *list;
+
+    inline void propose(int *, tsp_mut_properties *mut_conf) const {
+        list_neighbour_2opt(*list, mut_conf, *distances, *neighbours);
+    }
+
+    inline void apply(int *, tsp_mut_properties *mut_conf) const {
+        flip_segment(*list, mut_conf);
+    }
+
+    inline void save(const int *, int *, int) const {
+        list->save();
+    }
+
+    inline void saved(int *copy) const {
+        list->saved_tour(copy);
+    }
+};
+
+// `mutation_policy: random` or `bandit`: 'selector' picks the operator
+// of every move among double_bridge, swap, displacement and or_opt
+struct adaptive_move : array_tour_move {
+    const DistanceMatrix *distances;
+    OperatorSelector *selector;
+
+    adaptive_move(const DistanceMatrix *given_distances,
+            OperatorSelector *given_selector) :
+    distances(given_distances), selector(given_selector) {
+    }
+
+    inline void propose(int *tour, tsp_mut_properties *mut_conf) const {
+        switch (selector->next(mut_conf->length)) {
+            case SWAP_MUTATION:
+                swap(tour, mut_conf, *distances);
+                return;
+            case DISPLACEMENT_MUTATION:
+                displacement(tour, mut_conf, *distances);
+                return;
+            case OR_OPT_MUTATION:
+                or_opt(tour, mut_conf, *distances);
+                return;
+            default:
+                double_bridge(tour, mut_conf, *distances);
+                return;
+        }
+    }
+
+    inline void apply(int *tour, tsp_mut_properties *mut_conf) const {
+        update_tour(tour, mut_conf);
+        selector->accepted(mut_conf->length);
+    }
+};
+
+// stopping_criterion: max_iteration
+struct iteration_limit_stop {
+    long limit;
+
+    inline bool proceed(long iteration, long, int, bool) const {
+        return iteration < limit;
+    }
+};
+
+// stopping_criterion: point_of_convergence (and max_iteration)
+struct convergence_stop {
+    long limit;
+    double point_of_convergence;
+
+    inline bool proceed(long iteration, long idle_iteration, int,
+            bool) const {
+        return iteration < limit && (iteration < 100000 ||
+                idle_iteration * point_of_convergence < iteration);
+    }
+};
+
+// stopping_criterion: point_of_convergence and solution_quality (and
+// max_iteration)
+struct convergence_quality_stop {
+    long limit;
+    double point_of_convergence;
+    double solution_quality;
+
+    inline bool proceed(long iteration, long idle_iteration,
+            int best_tour_length, bool) const {
+        return iteration < limit && (iteration < 100000 ||
+                idle_iteration * point_of_convergence < iteration) &&
+                best_tour_length > solution_quality;
+    }
+};
+
+// stopping_criterion: list_convergence (and solution_quality, and
+// max_iteration): the run stops once all the entries of the list are equal
+// and the last 'idle_iterations' moves did not shorten the tour
+struct list_convergence_stop {
+    long limit;
+    long idle_iterations;
+    double solution_quality; // -1 if not given
+
+    inline bool proceed(long iteration, long idle_iteration,
+            int best_tour_length, bool list_converged) const {
+        return iteration < limit && !(list_converged &&
+                idle_iteration >= idle_iterations) &&
+                best_tour_length > solution_quality;
+    }
+};
+
+// what the recorders keep besides the records themselves
+typedef struct {
+    long events; // records made, kept or not
+    long last_iteration; // of the last record made
+    int tolerance; // most the `reservoir` curve is above the real one
+} progress_state;
+
+// a record of the state after 'iteration', counted in 'state'
+inline lahc_results make_record(progress_state *state, long iteration,
+        int best_tour_length, double list_avg) {
+    lahc_results record;
+    record.iteration = iteration;
+    record.best_tour_length = best_tour_length;
+    record.list_avg = list_avg;
+    record.event = state->events++;
+    state->last_iteration = iteration;
+    return record;
+}
+
+// progress_recorder: all
+// keeps every improvement, for the progress reports
+struct improvement_recorder {
+    std::vector<lahc_results> *results;
+    SeedHistory *improvements; // NULL if no list seeds from them
+    progress_state *state;
+
+    // the state at the start and at the end of a run
+    inline void record(long iteration, int best_tour_length,
+            double list_avg) const {
+        results->push_back(make_record(state, iteration, best_tour_length,
+                list_avg));
+    }
+
+    inline void improved(long iteration, int best_tour_length,
+            double list_avg) const {
+        if (improvements != NULL)
+            improvements->add(best_tour_length);
+        record(iteration, best_tour_length, list_avg);
+    }
+};
+
+// progress_recorder: log, <buckets>
+// the iterations are split in 'buckets' buckets per doubling, and only the
+// last record of each bucket (and the first of the run) is kept, so a run
+// of N iterations keeps about buckets * log2(N) records. The curve is exact
+// at the kept records, and late between them.
+struct log_recorder {
+    std::vector<lahc_results> *results;
+    SeedHistory *improvements; // NULL if no list seeds from them
+    progress_state *state;
+    double buckets;
+
+    inline long bucket(long iteration) const {
+        return long(buckets * log2(iteration + 1.));
+    }
+
+    inline void record(long iteration, int best_tour_length,
+            double list_avg) const {
+        lahc_results record = make_record(state, iteration,
+                best_tour_length, list_avg);
+        if (results->size() > 1 &&
+                bucket(results->back().iteration) == bucket(iteration))
+            results->back() = record;
+        else
+            results->push_back(record);
+    }
+
+    inline void improved(long iteration, int best_tour_length,
+            double list_avg) const {
+        if (improvements != NULL)
+            improvements->add(best_tour_length);
+        record(iteration, best_tour_length, list_avg);
+    }
+};
+
+// progress_recorder: reservoir, <capacity>
+// once 'capacity' records are kept, the records whose neighbours differ by
+// at most 'tolerance' are dropped, and 'tolerance' doubles until at most
+// half of the reservoir is used. The first and the last records are always
+// kept, and at every iteration the kept curve is at most 'tolerance' above
+// the real one (and its list average that of the last kept record).
+struct reservoir_recorder {
+    std::vector<lahc_results> *results;
+    SeedHistory *improvements; // NULL if no list seeds from them
+    progress_state *state;
+    size_t capacity;
+
+    inline void record(long iteration, int best_tour_length,
+            double list_avg) const {
+        results->push_back(make_record(state, iteration, best_tour_length,
+                list_avg));
+        if (results->size() >= capacity)
+            compress();
+    }
+
+    inline void improved(long iteration, int best_tour_length,
+            double list_avg) const {
+        if (improvements != NULL)
+            improvements->add(best_tour_length);
+        record(iteration, best_tour_length, list_avg);
+    }
+
+    // the best lengths only go down, so dropping record i shows the kept
+    // record before it until the record after it, which is no more than
+    // their difference above the real curve
+    void compress() const {
+        std::vector<lahc_results> &kept = *results;
+        if (state->tolerance == 0)
+            state->tolerance = 1;
+        while (true) {
+            size_t size = 1;
+            for (size_t i = 1; i + 1 < kept.size(); i++)
+                if (kept[size - 1].best_tour_length -
+                        kept[i + 1].best_tour_length > state->tolerance)
+                    kept[size++] = kept[i];
+            kept[size++] = kept.back();
+            kept.resize(size);
+            if (size <= capacity / 2)
+                return;
+            state->tolerance *= 2;
+        }
+    }
+};
+
+#endif /* LAHC_POLICIES_H */
@@ -0,0 +1,72 @@
+/*
+ * File:    Migration.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: The exchange of best tours between the islands.
+ *
+ */
+
+#include "Migration.h"
+#include <climits>
+
+using namespace std;
+
+Migration::Migration(int islands, int cities, migration_type type) {
+    num_islands = islands;
+    num_cities = cities;
+    topology = type;
+    slots = new slot[num_islands];
+    for (int i = 0; i < num_islands; i++) {
+        slots[i].sequence.store(0);
+        slots[i].length.store(INT_MAX);
+        slots[i].tour = new std::atomic<int>[num_cities];
+    }
+}
+
+Migration::~Migration() {
+    for (int i = 0; i < num_islands; i++)
+        delete [] slots[i].tour;
+    delete [] slots;
+}
+
+void Migration::publish(int island, const int *tour, int length) {
+    slot &to = slots[island];
+    unsigned sequence = to.sequence.load(std::memory_order_relaxed);
+    to.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    to.length.store(length, std::memory_order_relaxed);
+    for (int i = 0; i < num_cities; i++)
+        to.tour[i].store(tour[i], std::memory_order_relaxed);
+    to.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+int Migration::receive(int island, int *tour, int length) {
+    if (topology == NO_MIGRATION)
+        return -1;
+    int from = (island + num_islands - 1) % num_islands;
+    if (topology == BROADCAST_MIGRATION)
+        for (int i = 0; i < num_islands; i++)
+            if (i != island && slots[i].length.load(
+                    std::memory_order_relaxed) < slots[from].length.load(
+                    std::memory_order_relaxed))
+                from = i;
+    if (slots[from].length.load(std::memory_order_relaxed) >= length)
+        return -1;
+    int received;
+    if (!copy(from, tour, received) || received >= length)
+        return -1;
+    return received;
+}
+
+bool Migration::copy(int island, int *tour, int &length) {
+    slot &from = slots[island];
+    unsigned before = from.sequence.load(std::memory_order_acquire);
+    if (before & 1)
+        return false;
+    length = from.length.load(std::memory_order_relaxed);
+    for (int i = 0; i < num_cities; i++)
+        tour[i] = from.tour[i].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return from.sequence.load(std::memory_order_relaxed) == before;
+}
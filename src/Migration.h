@@ -0,0 +1,51 @@
+/*
+ * File:    Migration.h
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: The exchange of best tours between the islands of an
+ * island-model LAHC (`islands`, `migration`).
+ * Every island has a slot, where only it writes its best tour ('publish'),
+ * and from which the other islands copy it ('receive'). A slot is a
+ * sequence lock over atomic cities: the writer makes the sequence odd,
+ * writes, and makes it even again; a reader copies the tour and keeps it
+ * only if the sequence was even and did not change meanwhile. Nobody
+ * waits: a copy that was torn by a write is dropped, and the island tries
+ * again at its next migration.
+ * An island receives the tour of the island before it (`ring`) or the
+ * best tour of all the other islands (`broadcast`), if it is shorter than
+ * its own best.
+ *
+ * Created on October 17, 2026
+ */
+
+#ifndef MIGRATION_H
+#define MIGRATION_H
+
+#include "Configuration.h"
+#include <atomic>
+
+class Migration {
+public:
+    Migration(int num_islands, int num_cities, migration_type topology);
+    ~Migration();
+    void publish(int island, const int *tour, int length);
+    // the length of the tour received in 'tour', or -1 if there is no
+    // tour shorter than 'length' to receive
+    int receive(int island, int *tour, int length);
+private:
+    typedef struct {
+        std::atomic<unsigned> sequence; // odd while it is written
+        std::atomic<int> length; // INT_MAX until the first tour
+        std::atomic<int> *tour;
+    } slot;
+
+    int num_islands;
+    int num_cities;
+    migration_type topology;
+    slot *slots;
+
+    bool copy(int island, int *tour, int &length);
+};
+
+#endif /* MIGRATION_H */
@@ -0,0 +1,207 @@
+/*
+ * File:    NeighbourLists.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: The k nearest neighbours (candidate lists) of every city of a
+ * TSP instance, sorted by increasing distance.
+ *
+ */
+
+#include "NeighbourLists.h"
+
+using namespace std;
+
+#define KD_LEAF_SIZE 8
+
+namespace {
+
+    typedef struct {
+        int begin; // range of the node in 'kd_tree::order'
+        int end;
+        int split_dim; // -1 for leaves
+        double split;
+        int left;
+        int right;
+    } kd_node;
+
+    typedef struct {
+        double square_distance;
+        int city;
+    } kd_candidate;
+
+    bool closer(const kd_candidate &a, const kd_candidate &b) {
+        if (a.square_distance != b.square_distance)
+            return a.square_distance < b.square_distance;
+        return a.city < b.city;
+    }
+
+    class kd_tree {
+    public:
+
+        kd_tree(int n, const double *x, const double *y) {
+            coord[0] = x;
+            coord[1] = y;
+            order.resize(n);
+            for (int i = 0; i < n; i++)
+                order[i] = i;
+            nodes.reserve(2 * (n / KD_LEAF_SIZE + 1));
+            build(0, n);
+        }
+
+        // the 'k' nearest cities of 'city' (excluding itself) in 'out'
+        void nearest(int city, int k, int *out) {
+            heap.clear();
+            query_x = coord[0][city];
+            query_y = coord[1][city];
+            query_city = city;
+            query_k = k;
+            search(0);
+            sort_heap(heap.begin(), heap.end(), closer);
+            for (int i = 0; i < k; i++)
+                out[i] = heap[i].city;
+        }
+
+    private:
+        const double *coord[2]; // x and y of the cities
+        std::vector<int> order;
+        std::vector<kd_node> nodes;
+        std::vector<kd_candidate> heap; // max-heap of the current candidates
+        double query_x;
+        double query_y;
+        int query_city;
+        int query_k;
+
+        int build(int begin, int end) {
+            int index = nodes.size();
+            nodes.push_back({begin, end, -1, 0., -1, -1});
+            if (end - begin <= KD_LEAF_SIZE)
+                return index;
+            // split along the dimension with the largest spread
+            double min_c[2] = {coord[0][order[begin]],
+                coord[1][order[begin]]};
+            double max_c[2] = {min_c[0], min_c[1]};
+            for (int i = begin + 1; i < end; i++)
+                for (int d = 0; d < 2; d++) {
+                    min_c[d] = std::min(min_c[d], coord[d][order[i]]);
+                    max_c[d] = std::max(max_c[d], coord[d][order[i]]);
+                }
+            int dim = (max_c[0] - min_c[0] >= max_c[1] - min_c[1]) ? 0 : 1;
+            int middle = begin + (end - begin) / 2;
+            const double *c = coord[dim];
+            std::nth_element(order.begin() + begin, order.begin() + middle,
+                    order.begin() + end, [c](int a, int b) {
+                        return c[a] < c[b];
+                    });
+            nodes[index].split_dim = dim;
+            nodes[index].split = c[order[middle]];
+            int left = build(begin, middle);
+            int right = build(middle, end);
+            nodes[index].left = left;
+            nodes[index].right = right;
+            return index;
+        }
+
+        void offer(int city) {
+            if (city == query_city)
+                return;
+            double xd = coord[0][city] - query_x;
+            double yd = coord[1][city] - query_y;
+            kd_candidate candidate = {xd * xd + yd * yd, city};
+            if ((int) heap.size() < query_k) {
+                heap.push_back(candidate);
+                push_heap(heap.begin(), heap.end(), closer);
+            } else if (closer(candidate, heap.front())) {
+                pop_heap(heap.begin(), heap.end(), closer);
+                heap.back() = candidate;
+                push_heap(heap.begin(), heap.end(), closer);
+            }
+        }
+
+        void search(int index) {
+            const kd_node &node = nodes[index];
+            if (node.split_dim < 0) {
+                for (int i = node.begin; i < node.end; i++)
+                    offer(order[i]);
+                return;
+            }
+            double diff = (node.split_dim == 0 ? query_x : query_y) -
+                    node.split;
+            int near = diff < 0 ? node.left : node.right;
+            int far = diff < 0 ? node.right : node.left;
+            search(near);
+            // visit the other side only if it may hold a closer city
+            if ((int) heap.size() < query_k ||
+                    diff * diff <= heap.front().square_distance)
+                search(far);
+        }
+    };
+}
+
+NeighbourLists::NeighbourLists() {
+    num_cities = 0;
+    k = 0;
+    lists = NULL;
+    owner = true;
+}
+
+NeighbourLists::~NeighbourLists() {
+    release();
+}
+
+void NeighbourLists::release() {
+    if (owner)
+        delete [] lists;
+    lists = NULL;
+    owner = true;
+}
+
+void NeighbourLists::build_from_coordinates(int n, const double *x,
+        const double *y, int num_neighbours) {
+    release();
+    num_cities = n;
+    k = std::min(num_neighbours, n - 1);
+    lists = new int[(size_t) n * k];
+    kd_tree tree(n, x, y);
+    for (int i = 0; i < n; i++)
+        tree.nearest(i, k, lists + (size_t) i * k);
+}
+
+void NeighbourLists::build_from_matrix(const DistanceMatrix &dis_matrix,
+        int num_neighbours) {
+    release();
+    num_cities = dis_matrix.dimension();
+    k = std::min(num_neighbours, num_cities - 1);
+    lists = new int[(size_t) num_cities * k];
+    std::vector<kd_candidate> row(num_cities - 1);
+    for (int i = 0; i < num_cities; i++) {
+        int m = 0;
+        for (int j = 0; j < num_cities; j++)
+            if (j != i)
+                row[m++] = {(double) dis_matrix(i, j), j};
+        std::partial_sort(row.begin(), row.begin() + k, row.end(), closer);
+        for (int j = 0; j < k; j++)
+            lists[(size_t) i * k + j] = row[j].city;
+    }
+}
+
+void NeighbourLists::map_lists(int n, int num_neighbours,
+        const int *mapped_lists) {
+    release();
+    num_cities = n;
+    k = num_neighbours;
+    lists = (int *) mapped_lists;
+    owner = false;
+}
+
+int NeighbourLists::size() const {
+    return k;
+}
+
+bool NeighbourLists::empty() const {
+    return lists == NULL;
+}
+
+const int *NeighbourLists::data() const {
+    return lists;
+}
@@ -0,0 +1,55 @@
+/*
+ * File:    NeighbourLists.h
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: The k nearest neighbours (candidate lists) of every city of a
+ * TSP instance, sorted by increasing distance. For instances given by
+ * coordinates the lists are computed with a k-d tree in O(N k log N); for
+ * explicit instances each row of the distance matrix is partially sorted.
+ * The lists are stored in one block, 'k' entries per city. The block can also
+ * be mapped from a preprocessed instance file, in which case it is read-only
+ * and not owned.
+ *
+ * Created on October 17, 2026
+ */
+
+#ifndef NEIGHBOURLISTS_H
+#define NEIGHBOURLISTS_H
+
+#include "DistanceMatrix.h"
+#include "Util.h"
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+class NeighbourLists {
+public:
+    NeighbourLists();
+    ~NeighbourLists();
+    void build_from_coordinates(int num_cities, const double *x,
+            const double *y, int k);
+    void build_from_matrix(const DistanceMatrix &dis_matrix, int k);
+    void map_lists(int num_cities, int k, const int *lists);
+    int size() const;
+    bool empty() const;
+    const int *data() const;
+
+    // the 'k' nearest neighbours of 'city', the nearest one first
+    inline const int *of(int city) const {
+        return lists + (size_t) city * k;
+    }
+
+private:
+    int num_cities;
+    int k;
+    int *lists;
+    bool owner; // false if the lists are mapped from a file
+
+    void release();
+};
+
+#endif /* NEIGHBOURLISTS_H */
+
@@ -0,0 +1,128 @@
+/*
+ * File:    OperatorSelector.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: Picks the mutation operator of LAHC online, uniformly at
+ * random or with an epsilon-greedy bandit over the improvement per
+ * nanosecond of each operator.
+ *
+ */
+
+#include "OperatorSelector.h"
+
+using namespace std;
+
+// the names of the operators, in the order of 'tsp_mutation_type'
+static const char *operator_names[NUM_OPERATORS] = {"double_bridge", "swap",
+    "displacement", "or_opt"};
+
+OperatorSelector::OperatorSelector() {
+    init(false, NULL);
+}
+
+void OperatorSelector::init(bool bandit_policy, RandomStream *stream) {
+    bandit = bandit_policy;
+    random = stream;
+    for (int i = 0; i < NUM_OPERATORS; i++) {
+        stats[i].proposed = stats[i].accepted = stats[i].improving = 0;
+        stats[i].improvement = stats[i].nanoseconds = stats[i].blocks = 0;
+        stats[i].value = 0.0;
+    }
+    current = DOUBLE_BRIDGE_MUTATION;
+    in_block = false;
+    left = 0;
+    length_before = 0;
+    block_improvement = 0;
+    block_start = std::chrono::steady_clock::now();
+}
+
+void OperatorSelector::finish() {
+    // the last block is usually not used up
+    if (in_block)
+        end_block();
+    left = 0;
+}
+
+void OperatorSelector::add(const OperatorSelector &other) {
+    for (int i = 0; i < NUM_OPERATORS; i++) {
+        stats[i].proposed += other.stats[i].proposed;
+        stats[i].accepted += other.stats[i].accepted;
+        stats[i].improving += other.stats[i].improving;
+        stats[i].improvement += other.stats[i].improvement;
+        stats[i].nanoseconds += other.stats[i].nanoseconds;
+        stats[i].blocks += other.stats[i].blocks;
+    }
+}
+
+void OperatorSelector::save(CheckpointOut &out) const {
+    out.put_array(stats, NUM_OPERATORS);
+    out.put(current);
+    out.put(in_block);
+    out.put(left);
+    out.put(length_before);
+    out.put(block_improvement);
+}
+
+void OperatorSelector::load(CheckpointIn &in) {
+    in.get_array(stats, NUM_OPERATORS);
+    in.get(current);
+    in.get(in_block);
+    in.get(left);
+    in.get(length_before);
+    in.get(block_improvement);
+    block_start = std::chrono::steady_clock::now();
+}
+
+string OperatorSelector::report() const {
+    string msg = "";
+    for (int i = 0; i < NUM_OPERATORS; i++) {
+        const operator_stats &s = stats[i];
+        msg += std::string(21, ' ') + ">> " + operator_names[i] + ": " +
+                std::to_string(s.proposed) + " moves, " +
+                std::to_string(s.accepted) + " accepted, " +
+                std::to_string(s.improving) + " improving (" +
+                std::to_string(s.improvement) + "), " +
+                std::to_string(s.nanoseconds / 1e6) + " ms, " +
+                std::to_string(s.nanoseconds > 0 ?
+                1e3 * s.improvement / s.nanoseconds : 0.0) +
+                " improvement/us\n";
+    }
+    return msg;
+}
+
+void OperatorSelector::next_block() {
+    if (in_block)
+        end_block();
+    current = choose();
+    in_block = true;
+    left = OPERATOR_BLOCK;
+    block_improvement = 0;
+    block_start = std::chrono::steady_clock::now();
+}
+
+void OperatorSelector::end_block() {
+    long nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - block_start).count();
+    in_block = false;
+    operator_stats &s = stats[current];
+    s.nanoseconds += nanoseconds;
+    s.blocks++;
+    double credit = block_improvement / (double) std::max(nanoseconds, 1L);
+    s.value += OPERATOR_STEP * (credit - s.value);
+}
+
+tsp_mutation_type OperatorSelector::choose() const {
+    if (!bandit)
+        return (tsp_mutation_type) random->below(NUM_OPERATORS);
+    for (int i = 0; i < NUM_OPERATORS; i++)
+        if (stats[i].blocks == 0)
+            return (tsp_mutation_type) i;
+    if (random->flip(OPERATOR_EPSILON))
+        return (tsp_mutation_type) random->below(NUM_OPERATORS);
+    int best = 0;
+    for (int i = 1; i < NUM_OPERATORS; i++)
+        if (stats[i].value > stats[best].value)
+            best = i;
+    return (tsp_mutation_type) best;
+}
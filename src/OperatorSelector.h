@@ -0,0 +1,104 @@
+/*
+ * File:    OperatorSelector.h
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: Picks the mutation operator of LAHC online, for the
+ * `mutation_policy` values `random` and `bandit`. The operators are the
+ * ones of TSP_mutation.h: double_bridge, swap, displacement and or_opt
+ * (indexed by 'tsp_mutation_type').
+ * One operator is used for a block of OPERATOR_BLOCK moves, so that the
+ * clock is read twice per block only. At the end of a block its credit is
+ * the improvement of the current tour (the sum over its accepted moves
+ * that shortened it) per nanosecond spent in the block, proposing,
+ * evaluating and applying moves.
+ *      - random: every block, an operator uniformly at random,
+ *      - bandit: epsilon-greedy over the credits (Sutton and Barto, 2018):
+ *        every operator is used for one block first; then, with
+ *        probability OPERATOR_EPSILON, an operator uniformly at random, and
+ *        otherwise the one with the best value. The value of an operator
+ *        moves by OPERATOR_STEP towards the credit of each of its blocks,
+ *        so recent blocks weigh more and the choice follows the stage of
+ *        the search.
+ * Every operator counts its moves, accepted moves, improving moves, total
+ * improvement and time, for the report in the `.log`.
+ *
+ * Created on October 17, 2026
+ */
+
+#ifndef OPERATORSELECTOR_H
+#define OPERATORSELECTOR_H
+
+#include "TSP_mutation.h"
+#include "Util.h"
+#include "RandomStream.h"
+#include "Checkpoint.h"
+#include <chrono>
+#include <string>
+
+using namespace std;
+
+#define NUM_OPERATORS 4 // double_bridge, swap, displacement and or_opt
+#define OPERATOR_BLOCK 64 // moves in a block of one operator
+#define OPERATOR_EPSILON 0.1 // probability of exploring, for `bandit`
+#define OPERATOR_STEP 0.1 // weight of the last block in the value
+
+typedef struct {
+    long proposed;
+    long accepted;
+    long improving;
+    long improvement; // sum over the improving moves
+    long nanoseconds;
+    long blocks;
+    double value; // recency-weighted credit, improvement per nanosecond
+} operator_stats;
+
+class OperatorSelector {
+public:
+    operator_stats stats[NUM_OPERATORS];
+
+    OperatorSelector();
+    void init(bool bandit, RandomStream *random);
+    void finish();
+    void add(const OperatorSelector &other);
+    void save(CheckpointOut &out) const;
+    void load(CheckpointIn &in); // the block goes on from now
+    string report() const;
+
+    // the operator of the next move, from a tour of length 'length'; a
+    // new block starts when the current one is used up
+    inline tsp_mutation_type next(int length) {
+        if (left == 0)
+            next_block();
+        left--;
+        stats[current].proposed++;
+        length_before = length;
+        return current;
+    }
+
+    // the last move was accepted, and the tour is now 'length' long
+    inline void accepted(int length) {
+        stats[current].accepted++;
+        if (length < length_before) {
+            stats[current].improving++;
+            stats[current].improvement += length_before - length;
+            block_improvement += length_before - length;
+        }
+    }
+
+private:
+    bool bandit;
+    RandomStream *random; // the stream of the run
+    tsp_mutation_type current;
+    bool in_block; // the time of the current block is not counted yet
+    int left; // moves left in the block
+    int length_before; // of the tour, before the last move
+    long block_improvement;
+    std::chrono::steady_clock::time_point block_start;
+
+    void next_block();
+    void end_block();
+    tsp_mutation_type choose() const;
+};
+
+#endif /* OPERATORSELECTOR_H */
@@ -0,0 +1,77 @@
+/*
+ * File:    Race.h
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: What the lists of a parallel pLAHC (`race_threads`) share
+ * while they run at once: the best tour length of all of them and their
+ * iterations, both kept in atomics, and whether the race is over.
+ * A running list reports to the race every RACE_POLL iterations
+ * ('proceed'), and stops at its next report once the race is over: once
+ * a list reached the `solution_quality`, or the lists together used the
+ * `max_iteration` budget.
+ * The islands of an island-model LAHC (Islands.h) share a race too, for
+ * the `solution_quality` target alone.
+ *
+ * Created on October 17, 2026
+ */
+
+#ifndef RACE_H
+#define RACE_H
+
+#include "Configuration.h"
+#include <atomic>
+#include <climits>
+
+#define RACE_POLL 4096 // iterations between two reports of a list
+
+class Race {
+public:
+
+    Race(stopping_criteria criteria) : best_length(INT_MAX), iterations(0),
+    over(false) {
+        target = criteria.solution_quality ? criteria.solution_quality_par :
+                -1.;
+        budget = criteria.max_iteration ? criteria.max_iteration_par :
+                LONG_MAX;
+    }
+
+    // a list made 'new_iterations' more iterations, and its best tour is
+    // 'length' long; false once the race is over
+    inline bool proceed(long new_iterations, int length) {
+        int best = best_length.load(std::memory_order_relaxed);
+        while (length < best && !best_length.compare_exchange_weak(best,
+                length, std::memory_order_relaxed));
+        long total = iterations.fetch_add(new_iterations,
+                std::memory_order_relaxed) + new_iterations;
+        if (length <= target || total >= budget)
+            over.store(true, std::memory_order_relaxed);
+        return !over.load(std::memory_order_relaxed);
+    }
+
+    // the lists stop at their next report, as if the race were over
+    inline void end() {
+        over.store(true, std::memory_order_relaxed);
+    }
+
+    inline bool is_over() const {
+        return over.load(std::memory_order_relaxed);
+    }
+
+    inline int best_tour_length() const {
+        return best_length.load(std::memory_order_relaxed);
+    }
+
+    inline long total_iterations() const {
+        return iterations.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<int> best_length; // of all the lists
+    std::atomic<long> iterations; // of all the lists, as reported
+    std::atomic<bool> over;
+    double target; // `solution_quality`, -1 for none
+    long budget; // `max_iteration`, LONG_MAX for none
+};
+
+#endif /* RACE_H */
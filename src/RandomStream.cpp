@@ -0,0 +1,34 @@
+/*
+ * File:    RandomStream.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: Seeding of the xoshiro256** streams of the runs.
+ *
+ */
+
+#include "RandomStream.h"
+
+// the splitmix64 generator: adds the golden ratio to 'x', and returns a
+// mix of it
+static uint64_t splitmix64(uint64_t &x) {
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+RandomStream::RandomStream(uint64_t key) {
+    seed(key);
+}
+
+void RandomStream::seed(uint64_t key) {
+    // splitmix64 never gives four zeros in a row, so the state is valid
+    for (int i = 0; i < 4; i++)
+        state[i] = splitmix64(key);
+}
+
+uint64_t RandomStream::derive(uint64_t key, uint64_t index) {
+    uint64_t x = splitmix64(key) ^ index;
+    return splitmix64(x);
+}
@@ -0,0 +1,84 @@
+/*
+ * File:    RandomStream.h
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: A 64-bit random number generator, xoshiro256** (Blackman and
+ * Vigna, 2018), for the random numbers of a run. Every LAHC owns one, and
+ * the mutation operators draw from it through 'tsp_mut_properties', so
+ * that a run depends on its own stream only, whatever else runs before or
+ * beside it.
+ * A stream is set by a key; 'derive' makes the key of sub-stream 'index'
+ * of a key, e.g. of run i from `seed`, or of list j of a pLAHC run from
+ * the key of the run. The state is filled from the key with splitmix64.
+ * 'below' is the integer in 0..n-1 by the multiply-shift of Lemire (2019),
+ * with a rejection that removes its bias; it needs no division in almost
+ * all draws.
+ *
+ * Created on October 17, 2026
+ */
+
+#ifndef RANDOMSTREAM_H
+#define RANDOMSTREAM_H
+
+#include <stdint.h>
+
+class RandomStream {
+public:
+    RandomStream(uint64_t key = 0);
+    void seed(uint64_t key);
+    static uint64_t derive(uint64_t key, uint64_t index);
+
+    inline uint64_t next() {
+        uint64_t result = rotate(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotate(state[3], 45);
+        return result;
+    }
+
+    // an integer uniformly at random in 0..n-1, for 0 < n < 2^32
+    inline uint32_t below(uint32_t n) {
+        uint64_t m = (next() >> 32) * (uint64_t) n;
+        uint32_t low = (uint32_t) m;
+        if (low < n) {
+            uint32_t threshold = (uint32_t) (-n) % n;
+            while (low < threshold) {
+                m = (next() >> 32) * (uint64_t) n;
+                low = (uint32_t) m;
+            }
+        }
+        return (uint32_t) (m >> 32);
+    }
+
+    // an integer uniformly at random in a..b
+    inline long uniform(long a, long b) {
+        return a + below((uint32_t) (b - a + 1));
+    }
+
+    // a real number uniformly at random in [0, 1)
+    inline double uniform01() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    inline double uniform(double a, double b) {
+        return a + (b - a) * uniform01();
+    }
+
+    inline bool flip(double p) {
+        return uniform01() < p;
+    }
+
+private:
+    uint64_t state[4];
+
+    static inline uint64_t rotate(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+#endif /* RANDOMSTREAM_H */
@@ -0,0 +1,120 @@
+/*
+ * File:    RunPool.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: The pool of threads of the independent runs.
+ *
+ */
+
+#include "RunPool.h"
+#include <algorithm>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace std;
+
+RunPool::RunPool(int threads, bool pin, int cores) : deques(threads) {
+    num_threads = threads;
+    pin_threads = pin;
+    cores_per_thread = std::max(1, cores);
+    next_commit = 0;
+}
+
+int RunPool::size() const {
+    return num_threads;
+}
+
+void RunPool::run(int first_task, int end_task,
+        std::function<void(int)> work, std::function<void(int)> commit) {
+    if (num_threads == 1) {
+        for (int task = first_task; task < end_task; task++) {
+            work(task);
+            commit(task);
+        }
+        return;
+    }
+    for (int task = first_task; task < end_task; task++)
+        deques[(task - first_task) % num_threads].tasks.push_back(task);
+    done.assign(end_task - first_task, false);
+    next_commit = first_task;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; i++)
+        threads.push_back(std::thread(&RunPool::worker, this, i, first_task,
+                std::ref(work), std::ref(commit)));
+    for (int i = 0; i < num_threads; i++)
+        threads[i].join();
+}
+
+void RunPool::worker(int thread, int first_task,
+        std::function<void(int)> &work, std::function<void(int)> &commit) {
+    if (pin_threads)
+        pin(thread);
+    int task;
+    while (next_task(thread, task)) {
+        work(task);
+        std::lock_guard<std::mutex> guard(commit_lock);
+        done[task - first_task] = true;
+        while (next_commit - first_task < (int) done.size() &&
+                done[next_commit - first_task])
+            commit(next_commit++);
+    }
+}
+
+// the cores the process may run on (taskset, cgroups), in order
+static std::vector<int> allowed_core_ids() {
+    std::vector<int> cores;
+#ifdef __linux__
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof (allowed), &allowed) == 0)
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+            if (CPU_ISSET(cpu, &allowed))
+                cores.push_back(cpu);
+#endif
+    return cores;
+}
+
+int RunPool::allowed_cores() {
+    int cores = allowed_core_ids().size();
+    return cores > 0 ? cores :
+            std::max(1u, std::thread::hardware_concurrency());
+}
+
+void RunPool::pin(int thread) {
+#ifdef __linux__
+    std::vector<int> cores = allowed_core_ids();
+    if (cores.empty())
+        return;
+    // the threads the run starts inherit the set of its worker
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int i = 0; i < cores_per_thread; i++)
+        CPU_SET(cores[(thread * cores_per_thread + i) % cores.size()], &set);
+    pthread_setaffinity_np(pthread_self(), sizeof (set), &set);
+#endif
+}
+
+bool RunPool::next_task(int thread, int &task) {
+    {
+        std::lock_guard<std::mutex> guard(deques[thread].lock);
+        if (!deques[thread].tasks.empty()) {
+            task = deques[thread].tasks.front();
+            deques[thread].tasks.pop_front();
+            return true;
+        }
+    }
+    // steal the last task of the next thread that has one
+    for (int i = 1; i < num_threads; i++) {
+        task_deque &victim = deques[(thread + i) % num_threads];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,62 @@
+/*
+ * File:    RunPool.h
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: The pool of threads on which the independent runs of an
+ * experiment are done (`threads`).
+ * 'run' does 'work' for every task over the threads, and 'commit' for the
+ * tasks in their order: a task is committed once it and all the tasks
+ * before it are done, so what 'commit' writes is the same as in a serial
+ * experiment. Every thread has a deque of tasks (task t on thread
+ * t % threads); it takes its next task from the front of its own deque,
+ * and once that is empty, steals the last task of the deque of another
+ * thread. The tasks of a deque are done in order, so the next task to
+ * commit is usually running.
+ * With one thread, the tasks are done and committed on the calling thread.
+ * With 'pin', thread i is bound to 'cores' of the cores the process may
+ * run on, the i-th such group (modulo the number of cores), on Linux. A
+ * run that starts threads of its own (raced lists, islands) gets as many
+ * cores as it starts threads, and they keep to them.
+ *
+ * Created on October 17, 2026
+ */
+
+#ifndef RUNPOOL_H
+#define RUNPOOL_H
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+class RunPool {
+public:
+    RunPool(int threads, bool pin, int cores);
+    int size() const;
+    static int allowed_cores(); // the process may run on, at least 1
+    void run(int first_task, int end_task, std::function<void(int)> work,
+            std::function<void(int)> commit);
+private:
+    typedef struct {
+        std::mutex lock;
+        std::deque<int> tasks;
+    } task_deque;
+
+    int num_threads;
+    bool pin_threads;
+    int cores_per_thread; // bound to a thread, with 'pin_threads'
+    std::vector<task_deque> deques;
+    std::mutex commit_lock; // of 'done' and 'next_commit'
+    std::vector<bool> done;
+    int next_commit;
+
+    void worker(int thread, int first_task, std::function<void(int)> &work,
+            std::function<void(int)> &commit);
+    bool next_task(int thread, int &task);
+    void pin(int thread);
+};
+
+#endif /* RUNPOOL_H */
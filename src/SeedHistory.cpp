@@ -0,0 +1,177 @@
+/*
+ * File:    SeedHistory.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: The tour lengths from which pLAHC-s seeds its lists.
+ *
+ */
+
+#include "SeedHistory.h"
+
+using namespace std;
+
+SeedHistory::SeedHistory() {
+    init(0);
+}
+
+void SeedHistory::init(int cap) {
+    capacity = cap;
+    clear();
+}
+
+void SeedHistory::add_run(const std::vector<int> &descending) {
+    std::vector<int> merged_lengths;
+    std::vector<long> merged_weights;
+    merged_lengths.reserve(lengths.size() + descending.size());
+    if (!weights.empty())
+        merged_weights.reserve(merged_lengths.capacity());
+    size_t i = 0;
+    long j = long(descending.size()) - 1;
+    while (i < lengths.size() || j >= 0) {
+        if (j < 0 || (i < lengths.size() && lengths[i] <= descending[j])) {
+            merged_lengths.push_back(lengths[i]);
+            if (!weights.empty())
+                merged_weights.push_back(weights[i]);
+            i++;
+        } else {
+            merged_lengths.push_back(descending[j]);
+            if (!weights.empty())
+                merged_weights.push_back(1);
+            j--;
+        }
+    }
+    lengths.swap(merged_lengths);
+    weights.swap(merged_weights);
+    num_lengths += descending.size();
+    if (capacity > 0 && lengths.size() > capacity)
+        compress();
+}
+
+void SeedHistory::add(int length) {
+    run.push_back(length);
+    if (capacity > 0 && run.size() >= capacity)
+        flush();
+}
+
+void SeedHistory::flush() {
+    if (run.empty())
+        return;
+    add_run(run);
+    run.clear();
+}
+
+void SeedHistory::add_history(const SeedHistory &other) {
+    bool weighted = !weights.empty() || !other.weights.empty();
+    std::vector<int> merged_lengths;
+    std::vector<long> merged_weights;
+    merged_lengths.reserve(lengths.size() + other.lengths.size());
+    if (weighted)
+        merged_weights.reserve(merged_lengths.capacity());
+    size_t i = 0, j = 0;
+    while (i < lengths.size() || j < other.lengths.size()) {
+        if (j == other.lengths.size() || (i < lengths.size() &&
+                lengths[i] <= other.lengths[j])) {
+            merged_lengths.push_back(lengths[i]);
+            if (weighted)
+                merged_weights.push_back(weight(i));
+            i++;
+        } else {
+            merged_lengths.push_back(other.lengths[j]);
+            if (weighted)
+                merged_weights.push_back(other.weight(j));
+            j++;
+        }
+    }
+    lengths.swap(merged_lengths);
+    weights.swap(merged_weights);
+    num_lengths += other.num_lengths;
+    if (capacity > 0 && lengths.size() > capacity)
+        compress();
+    if (!other.run.empty())
+        add_run(other.run);
+}
+
+void SeedHistory::seed(int *list, int list_size) const {
+    // length i of the ascending lengths (counted with their weights) is
+    // in the seed 'full' times, and once more if i < 'rest'; the seed is
+    // written from its end, the smallest lengths first
+    long full = list_size / num_lengths;
+    long rest = list_size % num_lengths;
+    long first = 0; // of the lengths counted by entry k
+    int position = list_size;
+    for (size_t k = 0; position > 0; k++) {
+        long count = weight(k) * full +
+                std::max(0L, std::min(first + weight(k), rest) - first);
+        for (long c = 0; c < count; c++)
+            list[--position] = lengths[k];
+        first += weight(k);
+    }
+}
+
+bool SeedHistory::empty() const {
+    return num_lengths == 0;
+}
+
+long SeedHistory::size() const {
+    return num_lengths;
+}
+
+void SeedHistory::clear() {
+    lengths.clear();
+    lengths.shrink_to_fit();
+    weights.clear();
+    weights.shrink_to_fit();
+    run.clear();
+    run.shrink_to_fit();
+    num_lengths = 0;
+    keep_second = false;
+}
+
+void SeedHistory::save(CheckpointOut &out) const {
+    out.put((uint64_t) capacity);
+    out.put_vector(lengths);
+    out.put_vector(weights);
+    out.put(num_lengths);
+    out.put_vector(run);
+    out.put(keep_second);
+}
+
+void SeedHistory::load(CheckpointIn &in) {
+    uint64_t cap;
+    in.get(cap);
+    capacity = cap;
+    in.get_vector(lengths);
+    in.get_vector(weights);
+    in.get(num_lengths);
+    in.get_vector(run);
+    in.get(keep_second);
+}
+
+void SeedHistory::compress() {
+    if (weights.empty())
+        weights.assign(lengths.size(), 1);
+    size_t exact = capacity / 2;
+    while (lengths.size() > capacity) {
+        size_t kept = exact;
+        for (size_t i = exact; i < lengths.size(); i += 2) {
+            lengths[kept] = lengths[i];
+            weights[kept] = weights[i];
+            if (i + 1 < lengths.size()) {
+                // the pair is the length of its heavier entry, and of
+                // each entry in turn when they weigh the same, so that
+                // the merged lengths are neither too small nor too large
+                bool second = weights[i + 1] > weights[i] ||
+                        (weights[i + 1] == weights[i] && keep_second);
+                if (weights[i + 1] == weights[i])
+                    keep_second = !keep_second;
+                if (second)
+                    lengths[kept] = lengths[i + 1];
+                weights[kept] += weights[i + 1];
+            }
+            kept++;
+        }
+        lengths.resize(kept);
+        weights.resize(kept);
+    }
+}
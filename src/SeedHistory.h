@@ -0,0 +1,67 @@
+/*
+ * File:    SeedHistory.h
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: The tour lengths of the improvements of the former lists of
+ * pLAHC-s, from which the list of the next LAHC is seeded.
+ * The lengths are kept in ascending order. The improvements of a list are
+ * a descending run, so 'add_run' merges them in in linear time, and 'seed'
+ * writes the seed of a list already in descending order, without sorting.
+ * The seed of a list of size L is the first L of the lengths, repeated
+ * from the start while the L is more than the number of lengths.
+ * With a 'capacity', at most 'capacity' entries are kept: the smallest
+ * half of them exactly, and the rest as adjacent pairs merged into one
+ * entry that counts for both. The merged entry has the length of the
+ * heavier of the two; of two equally heavy ones it takes the smaller and
+ * the larger length in turn, so the lengths it stands for are spread
+ * around it rather than all above it. Memory stays flat, the number of
+ * lengths is still exact, and the seed of a list is exact as long as its
+ * size is at most capacity / 2, and close to it beyond that.
+ * A running list hands its improvements one at a time to 'add'. They
+ * wait in a descending run that is merged in once it holds 'capacity'
+ * lengths, or at 'flush', so the history of a list stays within twice
+ * its capacity; 'seed', 'size' and 'empty' only count the merged ones.
+ *
+ * Created on October 17, 2026
+ */
+
+#ifndef SEEDHISTORY_H
+#define SEEDHISTORY_H
+
+#include "Checkpoint.h"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+class SeedHistory {
+public:
+    SeedHistory();
+    void init(int capacity); // 0 keeps every length
+    void add_run(const std::vector<int> &descending);
+    void add(int length); // below all the lengths added so far
+    void flush();
+    void add_history(const SeedHistory &other);
+    void seed(int *list, int list_size) const;
+    bool empty() const;
+    long size() const; // number of lengths, kept exactly or merged
+    void clear();
+    void save(CheckpointOut &out) const;
+    void load(CheckpointIn &in);
+private:
+    size_t capacity; // most entries, 0 for all
+    std::vector<int> lengths; // ascending
+    std::vector<long> weights; // lengths counted by each entry, if merged
+    long num_lengths;
+    std::vector<int> run; // of 'add', descending, not merged in yet
+    bool keep_second; // of the next two equally heavy entries to merge
+
+    inline long weight(size_t i) const {
+        return weights.empty() ? 1 : weights[i];
+    }
+    void compress();
+};
+
+#endif /* SEEDHISTORY_H */
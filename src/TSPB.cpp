@@ -0,0 +1,88 @@
+/*
+ * File:    TSPB.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: Helpers of the preprocessed binary instance format (.tspb).
+ *
+ */
+
+#include "TSPB.h"
+#include <string.h>
+#include <fstream>
+
+using namespace std;
+
+#define HASH_MULTIPLIER 0x9E3779B97F4A7C15ull
+
+namespace {
+
+    inline uint64_t mix(uint64_t hash, uint64_t word) {
+        hash = (hash ^ word) * HASH_MULTIPLIER;
+        return hash ^ (hash >> 29);
+    }
+}
+
+uint64_t tspb_hash(const void *data, size_t bytes, uint64_t hash) {
+    // four independent lanes over 32-byte blocks, so a matrix of hundreds
+    // of MB is hashed at memory speed; the tail is hashed word by word
+    const unsigned char *p = (const unsigned char *) data;
+    uint64_t lane[4] = {hash, hash + 1, hash + 2, hash + 3};
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32)
+        for (int k = 0; k < 4; k++) {
+            uint64_t word;
+            memcpy(&word, p + i + 8 * k, 8);
+            lane[k] = mix(lane[k], word);
+        }
+    hash = mix(mix(mix(mix(bytes, lane[0]), lane[1]), lane[2]), lane[3]);
+    for (; i < bytes; i += 8) {
+        uint64_t word = 0;
+        memcpy(&word, p + i, bytes - i < 8 ? bytes - i : 8);
+        hash = mix(hash, word);
+    }
+    return hash;
+}
+
+uint64_t tspb_content_hash(const tspb_header &header, const char *comment,
+        const double *x, const double *y, const void *matrix,
+        const int *neighbours) {
+    uint64_t hash = header.dimension;
+    size_t n = header.dimension;
+    if (comment != NULL)
+        hash = tspb_hash(comment, header.comment_size, hash);
+    if (x != NULL && y != NULL) {
+        hash = tspb_hash(x, n * sizeof (double), hash);
+        hash = tspb_hash(y, n * sizeof (double), hash);
+    }
+    if (matrix != NULL)
+        hash = tspb_hash(matrix, tspb_matrix_bytes(header), hash);
+    if (neighbours != NULL)
+        hash = tspb_hash(neighbours, n * header.num_neighbours * sizeof (int),
+            hash);
+    return hash;
+}
+
+uint64_t tspb_header_hash(tspb_header header) {
+    header.header_hash = 0;
+    return tspb_hash(&header, sizeof (header), header.version);
+}
+
+uint64_t tspb_matrix_bytes(const tspb_header &header) {
+    uint64_t n = header.dimension;
+    if (header.matrix_layout == TSPB_TRIANGULAR_MATRIX)
+        return n * (n + 1) / 2 * header.element_width;
+    return header.stride * n * header.element_width;
+}
+
+bool is_tspb_file(string file) {
+    char magic[8];
+    std::ifstream in(file, ios::binary);
+    if (!in.read(magic, sizeof (magic)))
+        return false;
+    return memcmp(magic, TSPB_MAGIC, sizeof (magic)) == 0;
+}
+
+uint64_t tspb_align(uint64_t offset, uint64_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
@@ -0,0 +1,94 @@
+/*
+ * File:    TSPB.h
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: Layout of the preprocessed binary instance format (.tspb).
+ * A .tspb file is written by 'tsp2tspb' from a TSPLIB instance and holds
+ * everything that TSPLIB otherwise computes at start-up:
+ *      - a fixed-size header with the TSPLIB properties and the offset of
+ *        every section,
+ *      - the COMMENT of the instance,
+ *      - the coordinates as structure-of-arrays (all x, then all y), for
+ *        NODE_COORD_SECTION instances,
+ *      - the distance matrix, exactly as DistanceMatrix keeps it in memory
+ *        (16- or 32-bit elements; full rows padded to a cache line or the
+ *        packed upper triangle),
+ *      - optionally, the nearest neighbour lists.
+ * Sections start on a cache line boundary, and the matrix on a page
+ * boundary, so TSPLIB can mmap the file read-only and use the sections in
+ * place. All processes that map the same file share one copy of it in the
+ * page cache.
+ * The header carries a format version, a hash of the header itself (checked
+ * on every load) and a hash of all sections (checked by 'tsp2tspb --verify',
+ * and written in the log file to identify the instance).
+ * Integers are stored in the byte order of the machine that wrote the file;
+ * a file from a machine with the other byte order is rejected.
+ *
+ * Created on October 17, 2026
+ */
+
+#ifndef TSPB_H
+#define TSPB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+using namespace std;
+
+#define TSPB_MAGIC "TSPB\r\n\032\n"
+#define TSPB_VERSION 2 // 2: 'matrix_layout' added
+#define TSPB_BYTE_ORDER 0x01020304u
+#define TSPB_SECTION_ALIGNMENT 64
+#define TSPB_MATRIX_ALIGNMENT 4096
+#define TSPB_SQUARE_MATRIX 0
+#define TSPB_TRIANGULAR_MATRIX 1
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t header_size;
+    uint64_t header_hash; // hash of the header, with this field set to 0
+    uint64_t content_hash; // hash of all sections, without the padding
+    uint64_t file_size;
+    int32_t dimension;
+    int32_t element_width; // 2 or 4, or 0 if there is no matrix
+    uint64_t stride; // elements between two consecutive rows of the matrix
+    int32_t num_neighbours; // 0 if there are no neighbour lists
+    int32_t matrix_layout; // TSPB_SQUARE_MATRIX or TSPB_TRIANGULAR_MATRIX
+    // offsets of the sections from the start of the file (0: no section)
+    uint64_t comment_offset;
+    uint64_t comment_size;
+    uint64_t coordinates_offset;
+    uint64_t matrix_offset;
+    uint64_t neighbours_offset;
+    char name[64];
+    char type[32];
+    char format[32];
+    char edge_weight_type[32];
+    char edge_weight_format[32];
+} tspb_header;
+
+// 64-bit hash of 'bytes' bytes at 'data', chained from 'hash'
+uint64_t tspb_hash(const void *data, size_t bytes, uint64_t hash);
+
+// hash of the sections of a .tspb file, in the order they are stored;
+// missing sections are passed as NULL
+uint64_t tspb_content_hash(const tspb_header &header, const char *comment,
+        const double *x, const double *y, const void *matrix,
+        const int *neighbours);
+
+uint64_t tspb_header_hash(tspb_header header);
+
+// size of the matrix section described by 'header'
+uint64_t tspb_matrix_bytes(const tspb_header &header);
+
+// true if 'file' starts with the .tspb magic
+bool is_tspb_file(string file);
+
+// round 'offset' up to a multiple of 'alignment'
+uint64_t tspb_align(uint64_t offset, uint64_t alignment);
+
+#endif /* TSPB_H */
@@ -17,35 +17,108 @@
  *
  */
 #include "TSPLIB.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
 
 using namespace std;
 
-TSPLIB::TSPLIB(string tsp_instance_file) {
+namespace {
+
+    // maps 'file' read-only and sets 'size'; NULL if the file can't be
+    // mapped, e.g. it is empty or not a regular file
+    void *map_file(const string &file, size_t &size) {
+        int fd = open(file.c_str(), O_RDONLY);
+        if (fd < 0)
+            error("Couldn't open the given TSP instance file!");
+        struct stat file_status;
+        void *mapping = MAP_FAILED;
+        size = 0;
+        if (fstat(fd, &file_status) == 0 && S_ISREG(file_status.st_mode) &&
+                file_status.st_size > 0) {
+            size = file_status.st_size;
+            mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        return mapping == MAP_FAILED ? NULL : mapping;
+    }
+}
+
+// the 'auto' distance backend keeps a triangular matrix up to this size, and
+// computes the distances from the coordinates for bigger instances
+#define MAX_MATRIX_MB 1024
+// the cities are placed on a grid of this side for the Hilbert curve
+#define HILBERT_SIDE 65536u
+
+TSPLIB::TSPLIB(string tsp_instance_file, string backend, int cache_mb,
+        string city_renumbering) {
     tsp_instance_name = tsp_instance_file;
+    distance_backend = backend;
+    distance_cache_mb = cache_mb;
+    renumbering = city_renumbering;
+    cities_x = NULL;
+    cities_y = NULL;
+    original_id = NULL;
+    internal_id = NULL;
+    properties.DIMENSION = 0;
+    content_hash = 0;
+    mapping = NULL;
+    mapping_size = 0;
+    if (distance_backend != "auto" && distance_backend != "matrix" &&
+            distance_backend != "triangle" && distance_backend != "cache" &&
+            distance_backend != "coordinates")
+        error("Unknown distance_backend `" + distance_backend + "`!");
+    if (renumbering != "none" && renumbering != "hilbert")
+        error("Unknown renumbering `" + renumbering + "`!");
+    if (is_tspb_file(tsp_instance_name)) {
+        read_tspb_instance();
+        return;
+    }
     read_tsp_instance();
-    if (properties.FORMAT == "NODE_COORD_SECTION")
+    if (renumbering != "none" && properties.FORMAT != "NODE_COORD_SECTION")
+        error("The `" + renumbering + "` renumbering needs a "
+            "NODE_COORD_SECTION!");
+    if (properties.FORMAT == "NODE_COORD_SECTION") {
+        renumber_cities();
         set_distance_matrix();
+    }
 }
 
 TSPLIB::~TSPLIB() {
-    for (int i = properties.DIMENSION - 1; i >= 0; i--)
-        delete [] distance_matrix[i];
-    delete [] distance_matrix;
-    if (properties.FORMAT == "NODE_COORD_SECTION") {
-        for (int i = properties.DIMENSION - 1; i >= 0; i--)
-            delete [] cities[i];
-        delete [] cities;
-    }
+    delete [] cities_x;
+    delete [] cities_y;
+    delete [] original_id;
+    delete [] internal_id;
+    if (mapping != NULL)
+        munmap(mapping, mapping_size);
 }
 
 void TSPLIB::read_tsp_instance() {
-    std::ifstream in(tsp_instance_name);
-    if (in.good() != 1)
-        error("Couldn't open the given TSP instance file!");
+    // the whole file is mapped and scanned in place; files that can't be
+    // mapped (pipes, empty files) are read into a buffer instead
+    size_t size;
+    string buffer;
+    void *text_mapping = map_file(tsp_instance_name, size);
+    const char *text = (const char *) text_mapping;
+    if (text_mapping == NULL) {
+        std::ifstream in(tsp_instance_name, ios::binary);
+        if (in.good() != 1)
+            error("Couldn't open the given TSP instance file!");
+        buffer.assign(std::istreambuf_iterator<char>(in),
+                std::istreambuf_iterator<char>());
+        text = buffer.data();
+        size = buffer.size();
+    } else
+        madvise(text_mapping, size, MADV_SEQUENTIAL);
+    TextScanner in(text, text + size);
     string line, key, value;
     int lineNo = 0;
-    while (!in.eof() && properties.FORMAT == "") {
-        getline(in, line);
+    while (!in.at_end() && properties.FORMAT == "") {
+        line = in.next_line();
         lineNo++;
         trim_string_blanks(line);
         if (!line.empty()) // ignore empty lines
@@ -73,13 +146,204 @@ void TSPLIB::read_tsp_instance() {
             }
         }
     }
+    if (properties.FORMAT != "" && properties.DIMENSION <= 0)
+        error("The given TSP instance has no valid DIMENSION!");
     if (properties.FORMAT == "NODE_COORD_SECTION")
         read_node_coord_section(in);
     else if (properties.FORMAT == "EDGE_WEIGHT_SECTION")
         read_edge_weight_section(in);
     else
         error("Unexpected input line: " + line);
-    in.close();
+    if (text_mapping != NULL)
+        munmap(text_mapping, size);
+}
+
+void TSPLIB::read_tspb_instance() {
+    mapping = map_file(tsp_instance_name, mapping_size);
+    if (mapping == NULL || mapping_size < sizeof (tspb_header))
+        error("The given .tspb file is truncated!");
+    const char *base = (const char *) mapping;
+    tspb_header header;
+    memcpy(&header, base, sizeof (header));
+    // version 1 files are version 2 files with square matrices
+    if (header.version < 1 || header.version > TSPB_VERSION)
+        error("Unsupported .tspb version " + std::to_string(header.version)
+            + ", convert the instance again with tsp2tspb!");
+    if (header.byte_order != TSPB_BYTE_ORDER)
+        error("The given .tspb file was written on a machine with another "
+            "byte order!");
+    if (header.header_size != sizeof (header) ||
+            header.header_hash != tspb_header_hash(header))
+        error("The header of the given .tspb file is corrupt!");
+    if (header.file_size != mapping_size)
+        error("The given .tspb file is truncated!");
+    size_t n = header.dimension;
+    auto fits = [&](uint64_t offset, uint64_t bytes, uint64_t alignment) {
+        return offset % alignment == 0 && offset >= sizeof (header) &&
+                offset + bytes <= mapping_size;
+    };
+    if (header.dimension < 2 ||
+            (header.comment_offset && !fits(header.comment_offset,
+            header.comment_size, 1)) ||
+            (header.coordinates_offset && !fits(header.coordinates_offset,
+            2 * n * sizeof (double), TSPB_SECTION_ALIGNMENT)) ||
+            (header.matrix_offset && ((header.matrix_layout ==
+            TSPB_SQUARE_MATRIX && header.stride < n) ||
+            (header.matrix_layout != TSPB_SQUARE_MATRIX &&
+            header.matrix_layout != TSPB_TRIANGULAR_MATRIX) ||
+            (header.element_width != 2 && header.element_width != 4))) ||
+            (header.matrix_offset && !fits(header.matrix_offset,
+            tspb_matrix_bytes(header), TSPB_SECTION_ALIGNMENT)) ||
+            (header.neighbours_offset && !fits(header.neighbours_offset,
+            n * header.num_neighbours * sizeof (int),
+            TSPB_SECTION_ALIGNMENT)))
+        error("The sections of the given .tspb file are corrupt!");
+
+    properties.NAME = string(header.name, strnlen(header.name,
+            sizeof (header.name)));
+    properties.TYPE = string(header.type, strnlen(header.type,
+            sizeof (header.type)));
+    properties.FORMAT = string(header.format, strnlen(header.format,
+            sizeof (header.format)));
+    properties.EDGE_WEIGHT_TYPE = string(header.edge_weight_type,
+            strnlen(header.edge_weight_type,
+            sizeof (header.edge_weight_type)));
+    properties.EDGE_WEIGHT_FORMAT = string(header.edge_weight_format,
+            strnlen(header.edge_weight_format,
+            sizeof (header.edge_weight_format)));
+    properties.DIMENSION = header.dimension;
+    if (header.comment_offset)
+        properties.COMMENT = string(base + header.comment_offset,
+            header.comment_size);
+    content_hash = header.content_hash;
+
+    // the coordinates are small; a private copy keeps them writable
+    if (header.coordinates_offset) {
+        cities_x = new double[n];
+        cities_y = new double[n];
+        memcpy(cities_x, base + header.coordinates_offset,
+                n * sizeof (double));
+        memcpy(cities_y, base + header.coordinates_offset +
+                n * sizeof (double), n * sizeof (double));
+    }
+    // the stored matrix and lists are in the order of the file, so they
+    // can't be used if the cities are renumbered
+    bool from_coordinates = distance_backend == "coordinates" ||
+            distance_backend == "cache" || renumbering != "none";
+    if (from_coordinates && cities_x == NULL)
+        error("The `" + (renumbering != "none" ? renumbering + "` renumbering"
+            : distance_backend + "` distance backend") + " needs a "
+            "NODE_COORD_SECTION!");
+    if (header.matrix_offset && !from_coordinates)
+        distance_matrix.map_matrix(header.dimension, header.element_width,
+            header.stride, base + header.matrix_offset,
+            header.matrix_layout == TSPB_TRIANGULAR_MATRIX);
+    else {
+        renumber_cities();
+        set_distance_matrix();
+    }
+    if (header.neighbours_offset && renumbering == "none")
+        neighbours.map_lists(header.dimension, header.num_neighbours,
+            (const int *) (base + header.neighbours_offset));
+}
+
+void TSPLIB::write_tspb(string tspb_file, int num_neighbours) {
+    tspb_header header;
+    memset(&header, 0, sizeof (header)); // the padding is hashed too
+    memcpy(header.magic, TSPB_MAGIC, sizeof (header.magic));
+    header.version = TSPB_VERSION;
+    header.byte_order = TSPB_BYTE_ORDER;
+    header.header_size = sizeof (header);
+    header.dimension = properties.DIMENSION;
+    auto copy_property = [](char *field, size_t size, const string &value,
+            const string &key) {
+        if (value.size() >= size)
+            error("The " + key + " of the instance is too long for the "
+                ".tspb format!");
+        memcpy(field, value.c_str(), value.size());
+    };
+    copy_property(header.name, sizeof (header.name), properties.NAME,
+            "NAME");
+    copy_property(header.type, sizeof (header.type), properties.TYPE,
+            "TYPE");
+    copy_property(header.format, sizeof (header.format), properties.FORMAT,
+            "FORMAT");
+    copy_property(header.edge_weight_type, sizeof (header.edge_weight_type),
+            properties.EDGE_WEIGHT_TYPE, "EDGE_WEIGHT_TYPE");
+    copy_property(header.edge_weight_format,
+            sizeof (header.edge_weight_format), properties.EDGE_WEIGHT_FORMAT,
+            "EDGE_WEIGHT_FORMAT");
+
+    // the layout of the sections
+    size_t n = properties.DIMENSION;
+    const NeighbourLists *lists = NULL;
+    if (num_neighbours > 0) {
+        lists = &neighbour_lists(num_neighbours);
+        header.num_neighbours = lists->size();
+    }
+    uint64_t offset = sizeof (header);
+    if (!properties.COMMENT.empty()) {
+        header.comment_offset = offset;
+        header.comment_size = properties.COMMENT.size();
+        offset += header.comment_size;
+    }
+    if (cities_x != NULL) {
+        header.coordinates_offset = tspb_align(offset,
+                TSPB_SECTION_ALIGNMENT);
+        offset = header.coordinates_offset + 2 * n * sizeof (double);
+    }
+    if (distance_matrix.is_matrix()) {
+        header.element_width = distance_matrix.element_width();
+        header.stride = distance_matrix.row_stride();
+        header.matrix_layout = distance_matrix.is_triangular() ?
+                TSPB_TRIANGULAR_MATRIX : TSPB_SQUARE_MATRIX;
+        header.matrix_offset = tspb_align(offset, TSPB_MATRIX_ALIGNMENT);
+        offset = header.matrix_offset + tspb_matrix_bytes(header);
+    }
+    if (lists != NULL) {
+        header.neighbours_offset = tspb_align(offset, TSPB_SECTION_ALIGNMENT);
+        offset = header.neighbours_offset + n * header.num_neighbours *
+                sizeof (int);
+    }
+    header.file_size = offset;
+    header.content_hash = tspb_content_hash(header, header.comment_offset ?
+            properties.COMMENT.c_str() : NULL, cities_x, cities_y,
+            distance_matrix.rows(), lists ? lists->data() : NULL);
+    header.header_hash = tspb_header_hash(header);
+
+    // write into a temporary file and rename it, so that a process never
+    // maps a half-written instance
+    string temporary_file = tspb_file + ".tmp";
+    std::ofstream out(temporary_file, ios::binary);
+    if (!out.good())
+        error("Couldn't create the file " + temporary_file + "!");
+    auto write_section = [&out](uint64_t offset, const void *data,
+            uint64_t bytes) {
+        static const char zeros[TSPB_MATRIX_ALIGNMENT] = {0};
+        uint64_t position = out.tellp();
+        if (offset > position)
+            out.write(zeros, offset - position);
+        out.write((const char *) data, bytes);
+    };
+    write_section(0, &header, sizeof (header));
+    if (header.comment_offset)
+        write_section(header.comment_offset, properties.COMMENT.c_str(),
+            header.comment_size);
+    if (header.coordinates_offset) {
+        write_section(header.coordinates_offset, cities_x,
+                n * sizeof (double));
+        write_section(header.coordinates_offset + n * sizeof (double),
+                cities_y, n * sizeof (double));
+    }
+    if (header.matrix_offset)
+        write_section(header.matrix_offset, distance_matrix.rows(),
+            tspb_matrix_bytes(header));
+    if (header.neighbours_offset)
+        write_section(header.neighbours_offset, lists->data(),
+            n * header.num_neighbours * sizeof (int));
+    out.close();
+    if (!out.good() || rename(temporary_file.c_str(), tspb_file.c_str()) != 0)
+        error("Couldn't write the file " + tspb_file + "!");
 }
 
 void TSPLIB::set_property(string& key, string& value) {
@@ -103,80 +367,189 @@ void TSPLIB::set_property(string& key, string& value) {
     }
 }
 
-void TSPLIB::read_edge_weight_section(ifstream& inputfile) {
-    string in;
-    distance_matrix = new int*[properties.DIMENSION];
-    for (int i = 0; i < properties.DIMENSION; ++i)
-        distance_matrix[i] = new int[properties.DIMENSION];
+void TSPLIB::read_edge_weight_section(TextScanner &in) {
+    if (distance_backend == "coordinates" || distance_backend == "cache")
+        error("The `" + distance_backend + "` distance backend needs a "
+            "NODE_COORD_SECTION!");
+    long weight = 0;
+    // the maximum weight is only known after reading the whole section, so
+    // we read into 'int' elements and narrow the matrix afterwards
+    bool triangular = distance_backend != "matrix";
+    distance_matrix.allocate(properties.DIMENSION, -1, triangular);
     for (int i = 0; i < properties.DIMENSION; i++) {
         for (int j = i; j < properties.DIMENSION; j++) {
-            inputfile >> in;
-            distance_matrix[i][j] = distance_matrix[j][i] = atoi(in.c_str());
+            if (!in.parse_long(weight))
+                error("EDGE_WEIGHT_SECTION has a missing or malformed "
+                    "weight!");
+            distance_matrix.set(i, j, weight);
+            if (!triangular)
+                distance_matrix.set(j, i, weight);
         }
     }
+    distance_matrix.narrow();
     return;
 }
 
-void TSPLIB::read_node_coord_section(ifstream& inputfile) {
-    double x, y;
-    int k;
-    string line;
-    cities = new double*[properties.DIMENSION];
-    for (int i = 0; i < properties.DIMENSION; ++i)
-        cities[i] = new double[2];
-    while (!inputfile.eof()) {
-        getline(inputfile, line);
-        trim_string_blanks(line);
-        if (!line.empty() && line != "EOF") // ignore empty lines
-        {
-            sscanf(line.c_str(), "%d %lf %lf", &k, &x, &y);
-            cities[k - 1][0] = x;
-            cities[k - 1][1] = y;
-        }
+void TSPLIB::read_node_coord_section(TextScanner &in) {
+    double x = 0., y = 0.;
+    long k = 0;
+    cities_x = new double[properties.DIMENSION];
+    cities_y = new double[properties.DIMENSION];
+    // every city exactly once, as the arrays are not initialised
+    std::vector<bool> read(properties.DIMENSION, false);
+    int num_read = 0;
+    // one "k x y" entry per city, up to EOF or the next section
+    while (in.at_number()) {
+        if (!in.parse_long(k) || !in.parse_double(x) || !in.parse_double(y))
+            error("NODE_COORD_SECTION has a malformed line!");
+        if (k < 1 || k > properties.DIMENSION)
+            error("NODE_COORD_SECTION has a city number out of range!");
+        if (read[k - 1])
+            error("NODE_COORD_SECTION has city " + std::to_string(k) +
+                " more than once!");
+        read[k - 1] = true;
+        num_read++;
+        cities_x[k - 1] = x;
+        cities_y[k - 1] = y;
     }
+    if (num_read != properties.DIMENSION)
+        error("NODE_COORD_SECTION has " + std::to_string(num_read) +
+            " of the " + std::to_string(properties.DIMENSION) + " cities!");
     return;
 }
 
 void TSPLIB::set_distance_matrix() {
+    if (properties.EDGE_WEIGHT_TYPE != "EUC_2D" &&
+            properties.EDGE_WEIGHT_TYPE != "CEIL_2D")
+        error("Unsupported EDGE_WEIGHT_TYPE `" + properties.EDGE_WEIGHT_TYPE
+            + "`!");
+    long max_weight = max_coordinate_distance();
+    double matrix_mb = (max_weight <= 65535 ? 2. : 4.) * properties.DIMENSION
+            * (properties.DIMENSION + 1) / 2 / (1024. * 1024.);
+    if (distance_backend == "coordinates" ||
+            (distance_backend == "auto" && matrix_mb > MAX_MATRIX_MB)) {
+        distance_matrix.use_coordinates(properties.DIMENSION, cities_x,
+                cities_y, properties.EDGE_WEIGHT_TYPE == "CEIL_2D");
+        return;
+    }
+    if (distance_backend == "cache") {
+        distance_matrix.use_tile_cache(properties.DIMENSION, cities_x,
+                cities_y, properties.EDGE_WEIGHT_TYPE == "CEIL_2D", max_weight,
+                distance_cache_mb);
+        return;
+    }
+
     // here we calculate all distances and fill the matrix distance_matrix
-    distance_matrix = new int*[properties.DIMENSION];
-    for (int i = 0; i < properties.DIMENSION; ++i)
-        distance_matrix[i] = new int[properties.DIMENSION];
-        
-    if (properties.EDGE_WEIGHT_TYPE == "EUC_2D") {
-        for (int i = 0; i < properties.DIMENSION; i++)
-            for (int j = 0; j < properties.DIMENSION; j++)
-                distance_matrix[i][j] = euc_2d(i, j);
+    distance_matrix.allocate(properties.DIMENSION, max_weight,
+            distance_backend != "matrix");
+    distance_matrix.fill_from_coordinates(cities_x, cities_y,
+            properties.EDGE_WEIGHT_TYPE == "CEIL_2D");
+}
+
+void TSPLIB::renumber_cities() {
+    // relabel the cities in the order of a Hilbert curve through the
+    // bounding box, so that cities close in the plane get close ids; the
+    // distances of a 2-opt move then fall in fewer cache lines
+    if (renumbering == "none")
         return;
+    int n = properties.DIMENSION;
+    double min_x = cities_x[0], max_x = cities_x[0];
+    double min_y = cities_y[0], max_y = cities_y[0];
+    for (int i = 1; i < n; i++) {
+        min_x = std::min(min_x, cities_x[i]);
+        max_x = std::max(max_x, cities_x[i]);
+        min_y = std::min(min_y, cities_y[i]);
+        max_y = std::max(max_y, cities_y[i]);
+    }
+    double side = std::max(max_x - min_x, max_y - min_y);
+    double scale = side > 0 ? (HILBERT_SIDE - 1) / side : 0;
+    std::vector<std::pair<uint64_t, int> > order(n);
+    for (int i = 0; i < n; i++)
+        order[i] = std::make_pair(hilbert_index(
+            (uint32_t) ((cities_x[i] - min_x) * scale),
+            (uint32_t) ((cities_y[i] - min_y) * scale)), i);
+    std::sort(order.begin(), order.end());
+
+    original_id = new int[n];
+    internal_id = new int[n];
+    double *x = new double[n];
+    double *y = new double[n];
+    for (int i = 0; i < n; i++) {
+        original_id[i] = order[i].second;
+        internal_id[order[i].second] = i;
+        x[i] = cities_x[order[i].second];
+        y[i] = cities_y[order[i].second];
     }
-    if (properties.EDGE_WEIGHT_TYPE == "CEIL_2D") {
-        for (int i = 0; i < properties.DIMENSION; i++)
-            for (int j = 0; j < properties.DIMENSION; j++)
-                distance_matrix[i][j] = ceil_2d(i, j);
+    delete [] cities_x;
+    delete [] cities_y;
+    cities_x = x;
+    cities_y = y;
+}
+
+uint64_t TSPLIB::hilbert_index(uint32_t x, uint32_t y) {
+    // distance of (x, y) along the Hilbert curve that fills a square of
+    // HILBERT_SIDE x HILBERT_SIDE cells
+    uint64_t index = 0;
+    for (uint32_t s = HILBERT_SIDE / 2; s > 0; s /= 2) {
+        uint32_t rx = (x & s) > 0;
+        uint32_t ry = (y & s) > 0;
+        index += (uint64_t) s * s * ((3 * rx) ^ ry);
+        // rotate the quadrant, so that the curve inside it starts and ends
+        // at the right corners
+        if (ry == 0) {
+            if (rx == 1) {
+                x = HILBERT_SIDE - 1 - x;
+                y = HILBERT_SIDE - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return index;
+}
+
+void TSPLIB::to_internal_ids(int *tour) {
+    // 'tour' holds cities in the order of the instance file
+    if (internal_id == NULL)
         return;
+    for (int i = 0; i < properties.DIMENSION; i++)
+        tour[i] = internal_id[tour[i]];
+}
+
+long TSPLIB::max_coordinate_distance() {
+    // an upper bound of all distances: the diagonal of the bounding box of
+    // the cities, rounded up
+    double min_x = cities_x[0], max_x = cities_x[0];
+    double min_y = cities_y[0], max_y = cities_y[0];
+    for (int i = 1; i < properties.DIMENSION; i++) {
+        min_x = std::min(min_x, cities_x[i]);
+        max_x = std::max(max_x, cities_x[i]);
+        min_y = std::min(min_y, cities_y[i]);
+        max_y = std::max(max_y, cities_y[i]);
     }
+    double dx = max_x - min_x;
+    double dy = max_y - min_y;
+    return (long) ceil(sqrt(dx * dx + dy * dy)) + 1;
 }
 
 long TSPLIB::tour_length(int* tour) {
     long length = 0;
     for (int i = 0; i < properties.DIMENSION - 1; i++)
-        length += distance_matrix[tour[i]][tour[i + 1]];
-    length += distance_matrix[tour[properties.DIMENSION - 1]][tour[0]];
+        length += distance_matrix(tour[i], tour[i + 1]);
+    length += distance_matrix(tour[properties.DIMENSION - 1], tour[0]);
     return length;
 }
 
-int TSPLIB::euc_2d(int city1, int city2) {
-    double xd = cities[city1][0] - cities[city2][0];
-    double yd = cities[city1][1] - cities[city2][1];
-    double dist = sqrt(xd * xd + yd * yd) + 0.5;
-    return (int) dist;
-}
-
-int TSPLIB::ceil_2d(int city1, int city2) {
-    double xd = cities[city1][0] - cities[city2][0];
-    double yd = cities[city1][1] - cities[city2][1];
-    double dist = ceil(sqrt(xd * xd + yd * yd));
-    return (int) dist;
+const NeighbourLists &TSPLIB::neighbour_lists(int k) {
+    // the candidate lists are computed once, on the first request
+    if (neighbours.empty() || neighbours.size() < std::min(k,
+            properties.DIMENSION - 1)) {
+        if (properties.FORMAT == "NODE_COORD_SECTION")
+            neighbours.build_from_coordinates(properties.DIMENSION, cities_x,
+                cities_y, k);
+        else
+            neighbours.build_from_matrix(distance_matrix, k);
+    }
+    return neighbours;
 }
 
 bool TSPLIB::check_tour(int* tour) {
@@ -187,7 +560,8 @@ bool TSPLIB::check_tour(int* tour) {
     long tour_sum = 0;
     for (int i = 0; i < properties.DIMENSION; i++)
         tour_sum += tour[i];
-    if (tour_sum != (properties.DIMENSION * (properties.DIMENSION - 1) / 2.))
+    if (tour_sum != ((long) properties.DIMENSION *
+            (properties.DIMENSION - 1) / 2))
         error("The given tour has duplication!");
     return true;
 }
@@ -12,6 +12,14 @@
  *      3- Upper triangular distance matrices (including the diagonal):
  *                                          EDGE_WEIGHT_TYPE = EXPLICIT,
  *                                          EDGE_WEIGHT_FORMAT = UPPER_DIAG_ROW
+ * Text instances are mapped and read in place by a TextScanner.
+ * The cities of NODE_COORD_SECTION instances can be renumbered along a
+ * Hilbert curve, for locality in the distance matrix. The algorithms then
+ * work with the internal ids, and tours are mapped back to the ids of the
+ * instance file (original_city) whenever they are written.
+ * An instance can also be given as a preprocessed .tspb file (see TSPB.h),
+ * written by 'tsp2tspb'. Such a file is mapped read-only and its distance
+ * matrix and neighbour lists are used in place.
  * NOTE:
  *      This code is based on the code for DIMACS -- developed by Lyle McGeoch.
  *
@@ -22,6 +30,10 @@
 #define TSPLIB_H
 
 #include "Util.h"
+#include "DistanceMatrix.h"
+#include "NeighbourLists.h"
+#include "TSPB.h"
+#include "TextScanner.h"
 #include <stdlib.h> 
 #include <stdio.h>
 #include <string.h>
@@ -44,22 +56,44 @@ typedef struct {
 class TSPLIB {
 public:
     string tsp_instance_name;
-    int **distance_matrix;
-    double **cities;
+    string distance_backend;
+    int distance_cache_mb;
+    string renumbering; // `none` or `hilbert`
+    DistanceMatrix distance_matrix;
+    NeighbourLists neighbours;
+    double *cities_x; // coordinates, for NODE_COORD_SECTION instances
+    double *cities_y;
     tsplib_properties properties;
-    TSPLIB(string tsp_instance_file);
+    uint64_t content_hash; // of the .tspb file, 0 for text instances
+    TSPLIB(string tsp_instance_file, string distance_backend = "auto",
+            int distance_cache_mb = 256, string renumbering = "none");
     ~TSPLIB();
     long tour_length(int *tour);
     bool check_tour(int *tour);
+    const NeighbourLists &neighbour_lists(int k);
+    void write_tspb(string tspb_file, int num_neighbours);
+    void to_internal_ids(int *tour);
+
+    // the id in the instance file of the city with internal id 'city'
+    inline int original_city(int city) const {
+        return original_id == NULL ? city : original_id[city];
+    }
 
 private:
+    void *mapping; // the mapped .tspb file
+    size_t mapping_size;
+    int *original_id; // internal id -> file id, NULL if not renumbered
+    int *internal_id; // file id -> internal id
+
     void read_tsp_instance();
-    void read_node_coord_section(ifstream &inputfile);
-    void read_edge_weight_section(ifstream &inputfile);
+    void read_tspb_instance();
+    void read_node_coord_section(TextScanner &in);
+    void read_edge_weight_section(TextScanner &in);
     void set_property(string &key, string &value);
     void set_distance_matrix();
-    int euc_2d(int city1, int city2);
-    int ceil_2d(int city1, int city2);
+    long max_coordinate_distance();
+    void renumber_cities();
+    static uint64_t hilbert_index(uint32_t x, uint32_t y);
 };
 
 #endif /* TSPLIB_H */
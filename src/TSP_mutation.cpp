@@ -10,6 +10,9 @@
  * and add-in edges after applying one of them. It is designed for
  * SYMMETRIC TSP.
  * All operators return a mutated tour and a mutated edges.
+ * 'neighbour_2opt' is the same move as 'double_bridge', but the second cut
+ * is taken next to one of the nearest neighbours of the city at the first
+ * cut, so that the move always adds a short edge.
  * NOTE:
  *      * This operators are elaborated in the publication by Larranaga, 1999.
  *      * We only use 'double_bridge' operator as Burke and Bykov only used that
@@ -20,102 +23,252 @@
 #include "TSP_mutation.h"
 
 using namespace std;
-extern Random RANDOM; // random number generator
 
-void double_bridge(int *tour, tsp_mut_properties *tsp_mut, int **dis_matrix) {
+// the edges of reversing tour[cut0..cut1-1], with cut0 < cut1: edges 0
+// and 1 are subtracted, edges 2 and 3 are added
+static inline void reversal_edges(const int *tour, int num_cities, int cut0,
+        int cut1, int *from, int *to) {
+    int before_cut0 = tour[(cut0 != 0) ? cut0 - 1 : num_cities - 1];
+    from[0] = before_cut0;
+    to[0] = tour[cut0];
+    from[1] = tour[cut1 - 1];
+    to[1] = tour[cut1];
+    from[2] = tour[cut0];
+    to[2] = tour[cut1];
+    from[3] = before_cut0;
+    to[3] = tour[cut1 - 1];
+}
 
-    tsp_mut->mutation_type = "double_bridge";
-    pick_k_without_replacement(2, tsp_mut->num_cities, tsp_mut->cuts);
-    if (tsp_mut->cuts[0] > tsp_mut->cuts[1])
-        std::swap(tsp_mut->cuts[0], tsp_mut->cuts[1]);
-    int subtracted_cost = dis_matrix[tour[(tsp_mut->cuts[0] != 0) ?
-            tsp_mut->cuts[0] - 1 : tsp_mut->num_cities - 1]]
-            [tour[tsp_mut->cuts[0]]] + dis_matrix[tour[tsp_mut->cuts[1] - 1]]
-            [tour[tsp_mut->cuts[1]]];
-    int add_cost = dis_matrix[tour[tsp_mut->cuts[0]]][tour[tsp_mut->cuts[1]]] +
-            dis_matrix[tour[(tsp_mut->cuts[0] != 0) ?
-            tsp_mut->cuts[0] - 1 : tsp_mut->num_cities - 1]]
-            [tour[tsp_mut->cuts[1] - 1]];
+// cost of reversing tour[cuts[0]..cuts[1]-1], with cuts[0] < cuts[1]
+static inline void reversal_cost(int *tour, tsp_mut_properties *tsp_mut,
+        const DistanceMatrix &dis_matrix) {
+    int from[4], to[4], edges[4];
+    reversal_edges(tour, tsp_mut->num_cities, tsp_mut->cuts[0],
+            tsp_mut->cuts[1], from, to);
+    dis_matrix.distances4(from, to, edges);
+    int subtracted_cost = edges[0] + edges[1];
+    int add_cost = edges[2] + edges[3];
     tsp_mut->length = tsp_mut->length - subtracted_cost + add_cost;
 }
 
-void swap(int *tour, tsp_mut_properties *tsp_mut, int **dis_matrix) {
-    tsp_mut->mutation_type = "swap";
-    pick_k_without_replacement(2, tsp_mut->num_cities, tsp_mut->cuts);
-    if (tsp_mut->cuts[0] > tsp_mut->cuts[1])
-        std::swap(tsp_mut->cuts[0], tsp_mut->cuts[1]);
+void double_bridge(int *tour, tsp_mut_properties *tsp_mut,
+        const DistanceMatrix &dis_matrix) {
+
+    tsp_mut->mutation_type = DOUBLE_BRIDGE_MUTATION;
+    tsp_mut->cut_pairs->next(tsp_mut->cuts);
+    reversal_cost(tour, tsp_mut, dis_matrix);
+}
+
+void double_bridge_batch(const int *tour, int num_cities,
+        const DistanceMatrix &dis_matrix, int count, int *cuts,
+        int *deltas, CutPairs &cut_pairs) {
+    // the same draws as 'count' calls of 'double_bridge', then the edges
+    // of all the moves in one call of 'distances'
+    int from[4 * MAX_MOVE_BATCH], to[4 * MAX_MOVE_BATCH];
+    int edges[4 * MAX_MOVE_BATCH];
+    for (int k = 0; k < count; k++) {
+        int *pair = cuts + 2 * k;
+        cut_pairs.next(pair);
+        reversal_edges(tour, num_cities, pair[0], pair[1], from + 4 * k,
+                to + 4 * k);
+    }
+    dis_matrix.distances(from, to, edges, 4 * count);
+    for (int k = 0; k < count; k++) {
+        int *e = edges + 4 * k;
+        deltas[k] = e[2] + e[3] - e[0] - e[1];
+    }
+}
+
+void neighbour_2opt(int *tour, tsp_mut_properties *tsp_mut,
+        const DistanceMatrix &dis_matrix, const NeighbourLists &neighbours) {
+    // the reversal adds the edge (tour[cuts[0]], tour[cuts[1]]) and the edge
+    // between their predecessors. To add the edge (city, neighbour), both
+    // cuts are put either on the two cities or right after them.
+    tsp_mut->mutation_type = DOUBLE_BRIDGE_MUTATION;
+    int first = tsp_mut->random->below(tsp_mut->num_cities);
+    int neighbour = neighbours.of(tour[first])
+            [tsp_mut->random->below(tsp_mut->num_neighbours)];
+    int second = tsp_mut->position[neighbour];
+    if (tsp_mut->random->flip(0.5)) {
+        first = (first + 1) % tsp_mut->num_cities;
+        second = (second + 1) % tsp_mut->num_cities;
+    }
+    tsp_mut->cuts[0] = std::min(first, second);
+    tsp_mut->cuts[1] = std::max(first, second);
+    reversal_cost(tour, tsp_mut, dis_matrix);
+}
+
+// cost of replacing the edges (a, b) and (c, d) by (a, c) and (b, d), with
+// the cities a, b, c, d in cuts[0..3]
+static inline void flip_cost(tsp_mut_properties *tsp_mut,
+        const DistanceMatrix &dis_matrix) {
+    int *cities = tsp_mut->cuts;
+    // edges 0 and 1 are subtracted, edges 2 and 3 are added
+    int from[4] = {cities[0], cities[2], cities[0], cities[1]};
+    int to[4] = {cities[1], cities[3], cities[2], cities[3]};
+    int edges[4];
+    dis_matrix.distances4(from, to, edges);
+    tsp_mut->length = tsp_mut->length - edges[0] - edges[1] + edges[2] +
+            edges[3];
+}
+
+void list_2opt(const TwoLevelList &list, tsp_mut_properties *tsp_mut,
+        const DistanceMatrix &dis_matrix) {
+    tsp_mut->mutation_type = DOUBLE_BRIDGE_MUTATION;
+    int *cities = tsp_mut->cuts;
+    tsp_mut->cut_pairs->next(cities); // a 2-opt move has no direction
+    cities[2] = cities[1];
+    cities[1] = list.next(cities[0]);
+    cities[3] = list.next(cities[2]);
+    flip_cost(tsp_mut, dis_matrix);
+}
+
+void list_neighbour_2opt(const TwoLevelList &list,
+        tsp_mut_properties *tsp_mut, const DistanceMatrix &dis_matrix,
+        const NeighbourLists &neighbours) {
+    // the move adds the edge (a, c): to add (city, neighbour), they are
+    // either a and c, or b and d
+    tsp_mut->mutation_type = DOUBLE_BRIDGE_MUTATION;
+    int *cities = tsp_mut->cuts;
+    int city = tsp_mut->random->below(tsp_mut->num_cities);
+    int neighbour = neighbours.of(city)
+            [tsp_mut->random->below(tsp_mut->num_neighbours)];
+    if (tsp_mut->random->flip(0.5)) {
+        cities[0] = city;
+        cities[1] = list.next(city);
+        cities[2] = neighbour;
+        cities[3] = list.next(neighbour);
+    } else {
+        cities[0] = list.prev(city);
+        cities[1] = city;
+        cities[2] = list.prev(neighbour);
+        cities[3] = neighbour;
+    }
+    flip_cost(tsp_mut, dis_matrix);
+}
+
+void swap(int *tour, tsp_mut_properties *tsp_mut,
+        const DistanceMatrix &dis_matrix) {
+    tsp_mut->mutation_type = SWAP_MUTATION;
+    tsp_mut->cut_pairs->next(tsp_mut->cuts);
     int index_dis = tsp_mut->cuts[1] - tsp_mut->cuts[0];
     if (index_dis == tsp_mut->num_cities - 1)
         std::swap(tsp_mut->cuts[0], tsp_mut->cuts[1]);
+    int before_cut0 = tour[(tsp_mut->cuts[0] != 0) ?
+            tsp_mut->cuts[0] - 1 : tsp_mut->num_cities - 1];
+    int after_cut1 = tour[(tsp_mut->cuts[1] + 1) % tsp_mut->num_cities];
+    int city0 = tour[tsp_mut->cuts[0]];
+    int city1 = tour[tsp_mut->cuts[1]];
+    int edges[8];
     if (index_dis <= 2 or index_dis == tsp_mut->num_cities - 1) {
-        int subtracted_cost = dis_matrix[tour[(tsp_mut->cuts[0] != 0) ?
-                tsp_mut->cuts[0] - 1 : tsp_mut->num_cities - 1]]
-                [tour[tsp_mut->cuts[0]]] + dis_matrix[tour[tsp_mut->cuts[1]]]
-                [tour[(tsp_mut->cuts[1] + 1) % tsp_mut->num_cities]];
-        int add_cost = dis_matrix[tour[(tsp_mut->cuts[0] != 0) ?
-                tsp_mut->cuts[0] - 1 : tsp_mut->num_cities - 1]]
-                [tour[tsp_mut->cuts[1]]] + dis_matrix[tour[tsp_mut->cuts[0]]]
-                [tour[(tsp_mut->cuts[1] + 1) % tsp_mut->num_cities]];
+        // edges 0 and 1 are subtracted, edges 2 and 3 are added
+        int from[4] = {before_cut0, city1, before_cut0, city0};
+        int to[4] = {city0, after_cut1, city1, after_cut1};
+        dis_matrix.distances4(from, to, edges);
+        int subtracted_cost = edges[0] + edges[1];
+        int add_cost = edges[2] + edges[3];
         tsp_mut->length = tsp_mut->length - subtracted_cost + add_cost;
         return;
     }
-    int subtracted_cost = dis_matrix[tour[(tsp_mut->cuts[0] != 0) ?
-            tsp_mut->cuts[0] - 1 : tsp_mut->num_cities - 1]]
-            [tour[tsp_mut->cuts[0]]] +
-            dis_matrix[tour[tsp_mut->cuts[0]]][tour[tsp_mut->cuts[0] + 1]] +
-            dis_matrix[tour[tsp_mut->cuts[1] - 1]][tour[tsp_mut->cuts[1]]] +
-            dis_matrix[tour[tsp_mut->cuts[1]]]
-            [tour[(tsp_mut->cuts[1] + 1) % tsp_mut->num_cities]];
-    int add_cost = dis_matrix[tour[(tsp_mut->cuts[0] != 0) ?
-            tsp_mut->cuts[0] - 1 : tsp_mut->num_cities - 1]]
-            [tour[tsp_mut->cuts[1]]] +
-            dis_matrix[tour[tsp_mut->cuts[1]]][tour[tsp_mut->cuts[0] + 1]] +
-            dis_matrix[tour[tsp_mut->cuts[0]]][tour[tsp_mut->cuts[1] - 1]] +
-            dis_matrix[tour[tsp_mut->cuts[0]]]
-            [tour[(tsp_mut->cuts[1] + 1) % tsp_mut->num_cities]];
+    // edges 0 to 3 are subtracted, edges 4 to 7 are added
+    int from[8] = {before_cut0, city0, tour[tsp_mut->cuts[1] - 1], city1,
+        before_cut0, city1, city0, city0};
+    int to[8] = {city0, tour[tsp_mut->cuts[0] + 1], city1, after_cut1,
+        city1, tour[tsp_mut->cuts[0] + 1], tour[tsp_mut->cuts[1] - 1],
+        after_cut1};
+    dis_matrix.distances4(from, to, edges);
+    dis_matrix.distances4(from + 4, to + 4, edges + 4);
+    int subtracted_cost = edges[0] + edges[1] + edges[2] + edges[3];
+    int add_cost = edges[4] + edges[5] + edges[6] + edges[7];
     tsp_mut->length = tsp_mut->length - subtracted_cost + add_cost;
 }
 
-void displacement(int *tour, tsp_mut_properties *tsp_mut, int **dis_matrix) {
-    tsp_mut->mutation_type = "displacement";
-    pick_k_without_replacement(2, tsp_mut->num_cities, tsp_mut->cuts);
+void displacement(int *tour, tsp_mut_properties *tsp_mut,
+        const DistanceMatrix &dis_matrix) {
+    tsp_mut->mutation_type = DISPLACEMENT_MUTATION;
+    pick_k_without_replacement(2, tsp_mut->num_cities, tsp_mut->cuts,
+            *tsp_mut->random);
     int index_dis = tsp_mut->cuts[0] - tsp_mut->cuts[1];
     while (index_dis == tsp_mut->num_cities - 1 || index_dis == -1) {
-        pick_k_without_replacement(2, tsp_mut->num_cities, tsp_mut->cuts);
+        pick_k_without_replacement(2, tsp_mut->num_cities, tsp_mut->cuts,
+                *tsp_mut->random);
         index_dis = tsp_mut->cuts[0] - tsp_mut->cuts[1];
     }
-    int subtracted_cost = dis_matrix[tour[(tsp_mut->cuts[0] != 0) ?
-            tsp_mut->cuts[0] - 1 : tsp_mut->num_cities - 1]]
-            [tour[tsp_mut->cuts[0]]] + dis_matrix[tour[tsp_mut->cuts[0]]]
-            [tour[(tsp_mut->cuts[0] + 1) % tsp_mut->num_cities]] +
-            dis_matrix[tour[(tsp_mut->cuts[1] != 0) ?
-            tsp_mut->cuts[1] - 1 : tsp_mut->num_cities - 1]]
-            [tour[tsp_mut->cuts[1]]];
-    int add_cost = dis_matrix[tour[(tsp_mut->cuts[0] != 0) ?
-            tsp_mut->cuts[0] - 1 : tsp_mut->num_cities - 1]]
-            [tour[(tsp_mut->cuts[0] + 1) % tsp_mut->num_cities]] +
-            dis_matrix[tour[(tsp_mut->cuts[1] != 0) ?
-            tsp_mut->cuts[1] - 1 : tsp_mut->num_cities - 1]]
-            [tour[tsp_mut->cuts[0]]] + dis_matrix[tour[tsp_mut->cuts[0]]]
-            [tour[tsp_mut->cuts[1]]];
+    int before_cut0 = tour[(tsp_mut->cuts[0] != 0) ?
+            tsp_mut->cuts[0] - 1 : tsp_mut->num_cities - 1];
+    int after_cut0 = tour[(tsp_mut->cuts[0] + 1) % tsp_mut->num_cities];
+    int before_cut1 = tour[(tsp_mut->cuts[1] != 0) ?
+            tsp_mut->cuts[1] - 1 : tsp_mut->num_cities - 1];
+    int city0 = tour[tsp_mut->cuts[0]];
+    int city1 = tour[tsp_mut->cuts[1]];
+    // edges 0 to 2 are subtracted, edges 3 to 5 are added
+    int from[6] = {before_cut0, city0, before_cut1, before_cut0, before_cut1,
+        city0};
+    int to[6] = {city0, after_cut0, city1, after_cut0, city0, city1};
+    int edges[6];
+    dis_matrix.distances4(from, to, edges);
+    edges[4] = dis_matrix(from[4], to[4]);
+    edges[5] = dis_matrix(from[5], to[5]);
+    int subtracted_cost = edges[0] + edges[1] + edges[2];
+    int add_cost = edges[3] + edges[4] + edges[5];
+    tsp_mut->length = tsp_mut->length - subtracted_cost + add_cost;
+}
+
+void or_opt(int *tour, tsp_mut_properties *tsp_mut,
+        const DistanceMatrix &dis_matrix) {
+    tsp_mut->mutation_type = OR_OPT_MUTATION;
+    int n = tsp_mut->num_cities;
+    RandomStream *random = tsp_mut->random;
+    int length = random->uniform(1L, (long) std::min(OR_OPT_MAX_SEGMENT,
+            n - 3));
+    int begin = random->below(n - length + 1);
+    int end = begin + length;
+    // any position but the ones from just before the segment to its end
+    int after = (end + random->below(n - length - 1)) % n;
+    tsp_mut->cuts[0] = begin;
+    tsp_mut->cuts[1] = end;
+    tsp_mut->cuts[2] = after;
+    int before_segment = tour[(begin != 0) ? begin - 1 : n - 1];
+    int after_segment = tour[end % n];
+    int first = tour[begin];
+    int last = tour[end - 1];
+    int city = tour[after];
+    int next = tour[(after + 1) % n];
+    // edges 0 to 2 are subtracted, edge 3 is added; then 4 and 5 are added
+    // in the same orientation, or 6 and 7 reversed
+    int from[8] = {before_segment, last, city, before_segment,
+        city, last, city, first};
+    int to[8] = {first, after_segment, next, after_segment,
+        first, next, last, next};
+    int edges[8];
+    dis_matrix.distances4(from, to, edges);
+    dis_matrix.distances4(from + 4, to + 4, edges + 4);
+    tsp_mut->reversed = edges[6] + edges[7] < edges[4] + edges[5];
+    int add_cost = edges[3] + (tsp_mut->reversed ? edges[6] + edges[7] :
+            edges[4] + edges[5]);
+    int subtracted_cost = edges[0] + edges[1] + edges[2];
     tsp_mut->length = tsp_mut->length - subtracted_cost + add_cost;
 }
 
 void update_tour(int *tour, tsp_mut_properties *tsp_mut) {
     // update the tour based on the applied mutation
-    if (tsp_mut->mutation_type == "double_bridge") {
-        int j = tsp_mut->cuts[1];
-        int stop = tsp_mut->cuts[0] +
-                int((tsp_mut->cuts[1] - tsp_mut->cuts[0] + 1) / 2);
-        for (int i = tsp_mut->cuts[0]; i < stop; i++)
-            std::swap(tour[i], tour[--j]);
+    if (tsp_mut->mutation_type == DOUBLE_BRIDGE_MUTATION) {
+        reverse_segment(tour, tsp_mut);
+        return;
+    }
+    if (tsp_mut->mutation_type == OR_OPT_MUTATION) {
+        move_segment(tour, tsp_mut);
         return;
     }
-    if (tsp_mut->mutation_type == "swap") {
+    if (tsp_mut->mutation_type == SWAP_MUTATION) {
         std::swap(tour[tsp_mut->cuts[0]], tour[tsp_mut->cuts[1]]);
+        if (tsp_mut->position != NULL) {
+            tsp_mut->position[tour[tsp_mut->cuts[0]]] = tsp_mut->cuts[0];
+            tsp_mut->position[tour[tsp_mut->cuts[1]]] = tsp_mut->cuts[1];
+        }
         return;
     }
-    if (tsp_mut->mutation_type == "displacement") {
+    if (tsp_mut->mutation_type == DISPLACEMENT_MUTATION) {
         int tmp;
         if (tsp_mut->cuts[0] < tsp_mut->cuts[1]) {
             tmp = tour[tsp_mut->cuts[0]];
@@ -129,6 +282,12 @@ void update_tour(int *tour, tsp_mut_properties *tsp_mut) {
                 tour[i] = tour[i - 1];
             tour[tsp_mut->cuts[1]] = tmp;
         }
+        if (tsp_mut->position != NULL) {
+            int from = std::min(tsp_mut->cuts[0], tsp_mut->cuts[1]);
+            int to = std::max(tsp_mut->cuts[0], tsp_mut->cuts[1]);
+            for (int i = from; i <= to; i++)
+                tsp_mut->position[tour[i]] = i;
+        }
         return;
     }
 }
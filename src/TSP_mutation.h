@@ -10,6 +10,26 @@
  * and add-in edges after applying one of them. It is designed for
  * SYMMETRIC TSP.
  * All operators return a mutated tour and a mutated edges.
+ * The random numbers come from the stream of the run, 'random'; the
+ * ordered cut pairs of 'double_bridge', 'swap' and 'list_2opt' come from
+ * the buffer 'cut_pairs'.
+ * 'neighbour_2opt' is the same move as 'double_bridge', but the second cut
+ * is taken next to one of the nearest neighbours of the city at the first
+ * cut, so that the move always adds a short edge. It needs the 'position'
+ * index of the tour, which 'update_tour' keeps up to date when it is set.
+ * 'or_opt' moves a segment of 1 to OR_OPT_MAX_SEGMENT cities,
+ * tour[cuts[0]..cuts[1]-1], to between tour[cuts[2]] and the next city,
+ * in the orientation of the two that gives the shorter tour ('reversed').
+ * Its cost is found from 8 distances, whatever the length of the tour.
+ * 'double_bridge_batch' draws 'count' 'double_bridge' moves at once, and
+ * finds their costs with one batched distance lookup ('distances'), so
+ * that the loads of all the moves overlap. The cuts of move k are in
+ * cuts[2k] and cuts[2k+1], and its change of the tour length in deltas[k].
+ * 'list_2opt' and 'list_neighbour_2opt' are the same moves as
+ * 'double_bridge' and 'neighbour_2opt' on a tour held in a TwoLevelList:
+ * the cuts are the cities a, b = next(a), c, d = next(c), the move
+ * replaces the edges (a, b) and (c, d) by (a, c) and (b, d), and
+ * 'flip_segment' applies it in O(sqrt(N)) instead of O(N).
  * NOTE:
  *      * This operators are elaborated in the publication by Larranaga, 1999.
  *      * We only use 'double_bridge' operator as Burke and Bykov only used that
@@ -22,24 +42,107 @@
 #define TSP_MUTATION_H
 
 #include "Util.h"
-#include "Random.h"
+#include "RandomStream.h"
+#include "CutPairs.h"
+#include "DistanceMatrix.h"
+#include "NeighbourLists.h"
+#include "TwoLevelList.h"
 #include <stdlib.h> 
 #include <algorithm>
 #include <iostream>
 
 using namespace std;
 
+typedef enum {
+    DOUBLE_BRIDGE_MUTATION, // and 'neighbour_2opt': a reversal
+    SWAP_MUTATION,
+    DISPLACEMENT_MUTATION,
+    OR_OPT_MUTATION
+} tsp_mutation_type;
+
+#define OR_OPT_MAX_SEGMENT 3 // longest segment moved by 'or_opt'
+#define MAX_MOVE_BATCH 64 // most moves drawn by 'double_bridge_batch'
+
 typedef struct {
-    string mutation_type;
-    int *cuts;
+    tsp_mutation_type mutation_type;
+    int *cuts; // 4 entries: 'or_opt' also sets cuts[2], the list moves all
     int length;
     int num_cities;
+    int *position; // position of each city in the tour, or NULL
+    int num_neighbours; // candidates used by 'neighbour_2opt'
+    bool reversed; // 'or_opt' reinserts the segment reversed
+    RandomStream *random; // the stream of the run, for the draws
+    CutPairs *cut_pairs; // ordered cut pairs, drawn from 'random'
 } tsp_mut_properties;
 
-void double_bridge(int *tour, tsp_mut_properties *tsp_mut, int **dis_matrix);
-void swap(int *tour, tsp_mut_properties *tsp_mut, int **dis_matrix);
-void displacement(int *tour, tsp_mut_properties *tsp_mut, int **dis_matrix);
+void double_bridge(int *tour, tsp_mut_properties *tsp_mut,
+        const DistanceMatrix &dis_matrix);
+void double_bridge_batch(const int *tour, int num_cities,
+        const DistanceMatrix &dis_matrix, int count, int *cuts, int *deltas,
+        CutPairs &cut_pairs);
+void swap(int *tour, tsp_mut_properties *tsp_mut,
+        const DistanceMatrix &dis_matrix);
+void displacement(int *tour, tsp_mut_properties *tsp_mut,
+        const DistanceMatrix &dis_matrix);
+void neighbour_2opt(int *tour, tsp_mut_properties *tsp_mut,
+        const DistanceMatrix &dis_matrix, const NeighbourLists &neighbours);
+void or_opt(int *tour, tsp_mut_properties *tsp_mut,
+        const DistanceMatrix &dis_matrix);
+void list_2opt(const TwoLevelList &list, tsp_mut_properties *tsp_mut,
+        const DistanceMatrix &dis_matrix);
+void list_neighbour_2opt(const TwoLevelList &list,
+        tsp_mut_properties *tsp_mut, const DistanceMatrix &dis_matrix,
+        const NeighbourLists &neighbours);
 void update_tour(int *tour, tsp_mut_properties *tsp_mut);
 
+// applies a 'double_bridge' or 'neighbour_2opt' move: reverses
+// tour[cuts[0]..cuts[1]-1] and, if 'position' is set, updates it
+inline void reverse_segment(int *tour, const tsp_mut_properties *tsp_mut) {
+    int j = tsp_mut->cuts[1];
+    int stop = tsp_mut->cuts[0] +
+            int((tsp_mut->cuts[1] - tsp_mut->cuts[0] + 1) / 2);
+    for (int i = tsp_mut->cuts[0]; i < stop; i++)
+        std::swap(tour[i], tour[--j]);
+    if (tsp_mut->position != NULL)
+        for (int i = tsp_mut->cuts[0]; i < tsp_mut->cuts[1]; i++)
+            tsp_mut->position[tour[i]] = i;
+}
+
+// applies an 'or_opt' move: the cities between the segment and its new
+// place shift by the length of the segment, and the segment is written in
+// the gap. Only the positions from the segment to its new place change.
+inline void move_segment(int *tour, const tsp_mut_properties *tsp_mut) {
+    int begin = tsp_mut->cuts[0], end = tsp_mut->cuts[1];
+    int after = tsp_mut->cuts[2];
+    int length = end - begin;
+    int segment[OR_OPT_MAX_SEGMENT];
+    if (tsp_mut->reversed)
+        std::reverse_copy(tour + begin, tour + end, segment);
+    else
+        std::copy(tour + begin, tour + end, segment);
+    int from, to; // the range of positions that change
+    if (after >= end) { // the segment moves forward
+        std::copy(tour + end, tour + after + 1, tour + begin);
+        from = begin;
+        to = after + 1;
+    } else { // the segment moves backward
+        std::copy_backward(tour + after + 1, tour + begin, tour + end);
+        from = after + 1;
+        to = end;
+    }
+    std::copy(segment, segment + length, tour + (after >= end ?
+            after + 1 - length : after + 1));
+    if (tsp_mut->position != NULL)
+        for (int i = from; i < to; i++)
+            tsp_mut->position[tour[i]] = i;
+}
+
+// applies a 'list_2opt' or 'list_neighbour_2opt' move
+inline void flip_segment(TwoLevelList &list,
+        const tsp_mut_properties *tsp_mut) {
+    list.flip(tsp_mut->cuts[0], tsp_mut->cuts[1], tsp_mut->cuts[2],
+            tsp_mut->cuts[3]);
+}
+
 #endif /* TSP_MUTATION_H */
 
@@ -0,0 +1,51 @@
+/*
+ * File:    TextScanner.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: Reads lines and numbers from a block of text without copying
+ * it.
+ *
+ */
+
+#include "TextScanner.h"
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+// all of them are exact in double precision
+const double TextScanner::powers_of_ten[23] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5,
+    1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+    1e19, 1e20, 1e21, 1e22};
+
+TextScanner::TextScanner(const char *begin, const char *end) {
+    next = begin;
+    this->end = end;
+}
+
+bool TextScanner::at_end() const {
+    return next >= end;
+}
+
+string TextScanner::next_line() {
+    const char *line_end = (const char *) memchr(next, '\n', end - next);
+    if (line_end == NULL)
+        line_end = end;
+    string line(next, line_end);
+    next = (line_end < end) ? line_end + 1 : end;
+    if (!line.empty() && line[line.size() - 1] == '\r')
+        line.erase(line.size() - 1);
+    return line;
+}
+
+bool TextScanner::parse_double_slow(const char *token_end, double &value) {
+    // strtod needs a terminated string; the text may be a read-only mapping
+    string token(next, token_end);
+    char *parsed_end;
+    value = strtod(token.c_str(), &parsed_end);
+    if (parsed_end != token.c_str() + token.size())
+        return false;
+    next = token_end;
+    return true;
+}
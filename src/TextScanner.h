@@ -0,0 +1,140 @@
+/*
+ * File:    TextScanner.h
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: Reads lines and numbers from a block of text, e.g. a memory
+ * mapped TSPLIB file, without copying it and without any allocation per
+ * number. Integers are parsed by hand. Decimal numbers use the fast path of
+ * Clinger's algorithm: a mantissa of at most 2^53 scaled by an exact power
+ * of ten (at most 10^22) is converted with one correctly rounded operation,
+ * so the result is the same as the one of strtod/sscanf. The other numbers
+ * (very long mantissas, big exponents, ...) are handed to strtod.
+ *
+ * Created on October 17, 2026
+ */
+
+#ifndef TEXTSCANNER_H
+#define TEXTSCANNER_H
+
+#include <stdint.h>
+#include <string>
+
+using namespace std;
+
+class TextScanner {
+public:
+    TextScanner(const char *begin, const char *end);
+    bool at_end() const;
+    // the rest of the current line, without the line break
+    string next_line();
+
+    // skips blanks and line breaks
+    inline void skip_blanks() {
+        while (next < end && is_blank(*next))
+            next++;
+    }
+
+    // true if the next token (after the blanks) looks like a number
+    inline bool at_number() {
+        skip_blanks();
+        return next < end && (is_digit(*next) || *next == '-' ||
+                *next == '+' || *next == '.');
+    }
+
+    // the next token as an integer; false if it is not one
+    inline bool parse_long(long &value) {
+        skip_blanks();
+        const char *p = next;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = (*p++ == '-');
+        const char *digits = p;
+        long result = 0;
+        while (p < end && is_digit(*p))
+            result = result * 10 + (*p++ - '0');
+        if (p == digits || (p < end && !is_blank(*p)))
+            return false;
+        value = negative ? -result : result;
+        next = p;
+        return true;
+    }
+
+    // the next token as a double; false if it is not a number
+    inline bool parse_double(double &value) {
+        skip_blanks();
+        const char *p = next;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = (*p++ == '-');
+        uint64_t mantissa = 0;
+        int significant = 0; // digits in 'mantissa', without leading zeros
+        int exponent = 0;
+        bool any_digit = false;
+        for (; p < end && is_digit(*p); p++, any_digit = true)
+            accumulate(*p, mantissa, significant);
+        if (p < end && *p == '.')
+            for (p++; p < end && is_digit(*p); p++, any_digit = true) {
+                accumulate(*p, mantissa, significant);
+                exponent--;
+            }
+        if (!any_digit)
+            return false;
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            p++;
+            bool negative_exponent = false;
+            if (p < end && (*p == '-' || *p == '+'))
+                negative_exponent = (*p++ == '-');
+            if (p == end || !is_digit(*p))
+                return false;
+            int e = 0;
+            for (; p < end && is_digit(*p); p++)
+                if (e < 100000)
+                    e = e * 10 + (*p - '0');
+            exponent += negative_exponent ? -e : e;
+        }
+        if (p < end && !is_blank(*p))
+            return false;
+        if (significant > 19 || mantissa > (1ull << 53) || exponent < -22 ||
+                exponent > 22)
+            return parse_double_slow(p, value);
+        double result = (double) mantissa;
+        if (exponent < 0)
+            result /= powers_of_ten[-exponent];
+        else
+            result *= powers_of_ten[exponent];
+        value = negative ? -result : result;
+        next = p;
+        return true;
+    }
+
+private:
+    const char *next;
+    const char *end;
+    static const double powers_of_ten[23];
+
+    bool parse_double_slow(const char *token_end, double &value);
+
+    static inline bool is_digit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    static inline bool is_blank(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' ||
+                c == '\v' || c == '\f';
+    }
+
+    static inline void accumulate(char digit, uint64_t &mantissa,
+            int &significant) {
+        // past 19 digits the mantissa would overflow; such numbers take the
+        // slow path anyway
+        if (significant < 19) {
+            mantissa = mantissa * 10 + (digit - '0');
+            if (mantissa != 0)
+                significant++;
+        } else
+            significant++;
+    }
+};
+
+#endif /* TEXTSCANNER_H */
@@ -0,0 +1,355 @@
+/*
+ * File:    TwoLevelList.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: A tour stored as a two-level doubly-linked list, with 2-opt
+ * moves in O(sqrt(N)).
+ *
+ */
+
+#include "TwoLevelList.h"
+
+using namespace std;
+
+#define MAX_PARENT_FACTOR 8
+
+TwoLevelList::TwoLevelList() {
+    num_cities = 0;
+    num_parents = 0;
+    max_parent_size = 0;
+    too_large = false;
+    rebuilds = 0;
+    journaling = false;
+    saved_in_array = false;
+}
+
+void TwoLevelList::init(int n, const int *tour) {
+    num_cities = n;
+    int group_size = std::max(1, (int) sqrt((double) n));
+    num_parents = (n + group_size - 1) / group_size;
+    max_parent_size = MAX_PARENT_FACTOR * group_size;
+    too_large = false;
+    node.resize(n);
+    buffer.resize(std::max(n, num_parents));
+    tour_buffer.resize(n);
+    segment.resize(num_parents);
+    for (int p = 0; p < num_parents; p++) {
+        int begin = p * group_size;
+        int end = std::min(n, begin + group_size);
+        for (int i = begin; i < end; i++) {
+            int city = tour[i];
+            node[city].seq = i;
+            node[city].parent = p;
+            node[city].prev = (i > begin) ? tour[i - 1] : -1;
+            node[city].next = (i + 1 < end) ? tour[i + 1] : -1;
+        }
+        segment[p].first = tour[begin];
+        segment[p].last = tour[end - 1];
+        segment[p].size = end - begin;
+        segment[p].seq = p;
+        segment[p].next = (p + 1) % num_parents;
+        segment[p].prev = (p + num_parents - 1) % num_parents;
+        segment[p].reversed = 0;
+    }
+}
+
+void TwoLevelList::to_array(int *tour) const {
+    // segment by segment, from the segment of city 0
+    int p = node[0].parent;
+    int i = 0;
+    for (int k = 0; k < num_parents; k++, p = segment[p].next) {
+        if (segment[p].reversed)
+            for (int city = segment[p].last; ; city = node[city].prev) {
+                tour[i++] = city;
+                if (city == segment[p].first)
+                    break;
+            }
+        else
+            for (int city = segment[p].first; ; city = node[city].next) {
+                tour[i++] = city;
+                if (city == segment[p].last)
+                    break;
+            }
+    }
+}
+
+bool TwoLevelList::between(int a, int b, int c) const {
+    // true if 'b' is on the path that goes forward from 'a' to 'c'; the
+    // keys are the distances from 'a' along the tour, scaled per segment
+    long long span = (long long) num_parents * num_cities;
+    int pa = node[a].parent;
+    long long key[2];
+    int ends[2] = {b, c};
+    for (int i = 0; i < 2; i++) {
+        int p = node[ends[i]].parent;
+        key[i] = (long long) ((segment[p].seq - segment[pa].seq + num_parents) %
+                num_parents) * num_cities + rank(ends[i]);
+        if (p == pa && rank(ends[i]) < rank(a))
+            key[i] += span;
+    }
+    return key[0] <= key[1];
+}
+
+long TwoLevelList::num_rebuilds() const {
+    return rebuilds;
+}
+
+void TwoLevelList::save() {
+    journaling = true;
+    saved_in_array = false;
+    journal.clear();
+}
+
+void TwoLevelList::saved_tour(int *tour) {
+    // without a 'save', 'tour' is left as it is
+    if (saved_in_array)
+        std::copy(saved.begin(), saved.end(), tour);
+    else if (journaling)
+        write_saved(tour);
+}
+
+void TwoLevelList::write_saved(int *tour) {
+    // undo the journaled moves, read the tour, and redo them
+    int moves = journal.size() / 4;
+    for (int m = moves - 1; m >= 0; m--) {
+        int *move = &journal[4 * m];
+        flip_edges(move[0], move[2], move[1], move[3]);
+    }
+    to_array(tour);
+    for (int m = 0; m < moves; m++) {
+        int *move = &journal[4 * m];
+        flip_edges(move[0], move[1], move[2], move[3]);
+    }
+}
+
+void TwoLevelList::flip(int a, int b, int c, int d) {
+    // 'b' follows 'a' and 'd' follows 'c': the edges (a, b) and (c, d) are
+    // replaced by (a, c) and (b, d)
+    if (a == c || b == c || d == a)
+        return;
+    apply_flip(a, b, c, d);
+    if (!journaling)
+        return;
+    int move[4] = {a, b, c, d};
+    journal.insert(journal.end(), move, move + 4);
+    if ((int) journal.size() > 4 * num_parents) {
+        saved.resize(num_cities);
+        write_saved(saved.data());
+        saved_in_array = true;
+        journaling = false;
+        journal.clear();
+    }
+}
+
+void TwoLevelList::flip_edges(int a, int b, int c, int d) {
+    // the edges (a, b) and (c, d) are replaced by (a, c) and (b, d), in
+    // whichever direction the tour goes through them
+    if (next(a) == b)
+        apply_flip(a, b, c, d);
+    else
+        apply_flip(b, a, d, c);
+}
+
+void TwoLevelList::apply_flip(int a, int b, int c, int d) {
+    // reverses the path b..c or d..a, the one spanning fewer segments
+    if (node[b].parent == node[c].parent && rank(b) <= rank(c)) {
+        reverse_within(b, c);
+        return;
+    }
+    if (node[d].parent == node[a].parent && rank(d) <= rank(a)) {
+        reverse_within(d, a);
+        return;
+    }
+    int span_bc = (segment[node[c].parent].seq - segment[node[b].parent].seq +
+            num_parents) % num_parents;
+    int span_da = (segment[node[a].parent].seq - segment[node[d].parent].seq +
+            num_parents) % num_parents;
+    if (span_bc <= span_da)
+        reverse_path(b, c);
+    else
+        reverse_path(d, a);
+    if (too_large)
+        rebuild();
+}
+
+void TwoLevelList::reverse_within(int from, int to) {
+    // 'from' and 'to' are in the same segment, 'from' first in tour order
+    int p = node[from].parent;
+    if (from == head(p) && to == tail(p)) {
+        segment[p].reversed ^= 1;
+        return;
+    }
+    int low = segment[p].reversed ? to : from; // in the order of the segment
+    int high = segment[p].reversed ? from : to;
+    int length = 0;
+    for (int city = low; ; city = node[city].next) {
+        buffer[length++] = city;
+        if (city == high)
+            break;
+    }
+    int outer_prev = (low == segment[p].first) ? -1 : node[low].prev;
+    int outer_next = (high == segment[p].last) ? -1 : node[high].next;
+    int low_seq = node[low].seq;
+    for (int i = 0; i < length; i++) {
+        int city = buffer[length - 1 - i];
+        node[city].seq = low_seq + i;
+        node[city].prev = (i == 0) ? outer_prev : buffer[length - i];
+        node[city].next = (i == length - 1) ? outer_next :
+                buffer[length - 2 - i];
+    }
+    if (outer_prev != -1)
+        node[outer_prev].next = buffer[length - 1];
+    else
+        segment[p].first = buffer[length - 1];
+    if (outer_next != -1)
+        node[outer_next].prev = buffer[0];
+    else
+        segment[p].last = buffer[0];
+}
+
+void TwoLevelList::reverse_path(int from, int to) {
+    // 'from' and 'to' are in different segments: split them so that the
+    // path is made of whole segments, and reverse the order of those
+    make_head(from);
+    if (node[from].parent == node[to].parent) {
+        // 'from' moved to the start of the segment of 'to'
+        reverse_within(from, to);
+        return;
+    }
+    make_tail(to);
+    int p_from = node[from].parent;
+    int p_to = node[to].parent;
+    if (head(p_from) != from || tail(p_to) != to) {
+        // only with very few segments: the second split undid the first
+        reverse_by_rebuild(from, to);
+        return;
+    }
+    int m = 0;
+    for (int p = p_from; ; p = segment[p].next) {
+        buffer[m++] = p;
+        if (p == p_to)
+            break;
+    }
+    if (m == num_parents) {
+        reverse_by_rebuild(from, to);
+        return;
+    }
+    int before = segment[p_from].prev;
+    int after = segment[p_to].next;
+    int first_seq = segment[p_from].seq;
+    for (int i = 0; i < m; i++) {
+        int p = buffer[m - 1 - i];
+        // the segments keep the same places in the ring, in reverse order
+        segment[p].seq = (first_seq + i) % num_parents;
+        segment[p].reversed ^= 1;
+        segment[p].prev = (i == 0) ? before : buffer[m - i];
+        segment[p].next = (i == m - 1) ? after : buffer[m - 2 - i];
+    }
+    segment[before].next = buffer[m - 1];
+    segment[after].prev = buffer[0];
+}
+
+void TwoLevelList::reverse_by_rebuild(int from, int to) {
+    int n = 0;
+    for (int city = from; n < num_cities; city = next(city))
+        tour_buffer[n++] = city;
+    int length = 1;
+    while (tour_buffer[length - 1] != to)
+        length++;
+    std::reverse(tour_buffer.begin(), tour_buffer.begin() + length);
+    init(num_cities, tour_buffer.data());
+    rebuilds++;
+}
+
+void TwoLevelList::make_head(int city) {
+    // move the smaller part of the segment of 'city' to a neighbouring
+    // segment, so that 'city' starts a segment
+    int p = node[city].parent;
+    int before = rank(city);
+    if (before == 0)
+        return;
+    if (before <= segment[p].size - before)
+        move_to_prev_parent(p, before);
+    else
+        move_to_next_parent(p, segment[p].size - before);
+}
+
+void TwoLevelList::make_tail(int city) {
+    int p = node[city].parent;
+    int after = segment[p].size - 1 - rank(city);
+    if (after == 0)
+        return;
+    if (after <= segment[p].size - after)
+        move_to_next_parent(p, after);
+    else
+        move_to_prev_parent(p, segment[p].size - after);
+}
+
+void TwoLevelList::move_to_prev_parent(int p, int count) {
+    // the first 'count' cities of 'p' (tour order) go to the end of the
+    // segment before it
+    int q = segment[p].prev;
+    int city = head(p);
+    for (int i = 0; i < count; i++, city = next(city))
+        buffer[i] = city;
+    for (int i = 0; i < count; i++) {
+        int moved = buffer[i];
+        if (!segment[q].reversed) {
+            node[moved].prev = segment[q].last;
+            node[segment[q].last].next = moved;
+            node[moved].seq = node[segment[q].last].seq + 1;
+            segment[q].last = moved;
+        } else {
+            node[moved].next = segment[q].first;
+            node[segment[q].first].prev = moved;
+            node[moved].seq = node[segment[q].first].seq - 1;
+            segment[q].first = moved;
+        }
+        node[moved].parent = q;
+    }
+    if (!segment[p].reversed)
+        segment[p].first = city;
+    else
+        segment[p].last = city;
+    segment[p].size -= count;
+    segment[q].size += count;
+    too_large = too_large || segment[q].size > max_parent_size;
+}
+
+void TwoLevelList::move_to_next_parent(int p, int count) {
+    // the last 'count' cities of 'p' (tour order) go to the start of the
+    // segment after it
+    int r = segment[p].next;
+    int city = tail(p);
+    for (int i = 0; i < count; i++, city = prev(city))
+        buffer[i] = city;
+    for (int i = 0; i < count; i++) {
+        int moved = buffer[i];
+        if (!segment[r].reversed) {
+            node[moved].next = segment[r].first;
+            node[segment[r].first].prev = moved;
+            node[moved].seq = node[segment[r].first].seq - 1;
+            segment[r].first = moved;
+        } else {
+            node[moved].prev = segment[r].last;
+            node[segment[r].last].next = moved;
+            node[moved].seq = node[segment[r].last].seq + 1;
+            segment[r].last = moved;
+        }
+        node[moved].parent = r;
+    }
+    if (!segment[p].reversed)
+        segment[p].last = city;
+    else
+        segment[p].first = city;
+    segment[p].size -= count;
+    segment[r].size += count;
+    too_large = too_large || segment[r].size > max_parent_size;
+}
+
+void TwoLevelList::rebuild() {
+    to_array(tour_buffer.data());
+    init(num_cities, tour_buffer.data());
+    rebuilds++;
+}
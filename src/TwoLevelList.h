@@ -0,0 +1,131 @@
+/*
+ * File:    TwoLevelList.h
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: A tour stored as a two-level doubly-linked list (Fredman,
+ * Johnson, McGeoch and Ostheimer, 1995). The cities are split in about
+ * sqrt(N) segments ('parents'). Each segment is a doubly-linked list of
+ * cities with increasing sequence numbers, and the segments form a
+ * doubly-linked ring. Every segment has a reversal bit, so a whole segment
+ * is reversed in O(1).
+ * 'flip' applies a 2-opt move in O(sqrt(N)): a reversal inside one segment
+ * is done city by city, otherwise the ends of the path are moved to
+ * neighbouring segments until the path is made of whole segments, and
+ * those segments are reversed as a block. Of the path and its complement,
+ * the one spanning fewer segments is reversed (the tour is the same cycle).
+ * When a segment grows past MAX_PARENT_FACTOR times the initial segment
+ * size, the list is rebuilt from the tour in O(N).
+ * 'next', 'prev' and 'between' are O(1).
+ * 'save' keeps the current tour without copying it: the moves made after
+ * it are journaled, and 'saved_tour' undoes them, reads the tour and redoes
+ * them. Once the journal is longer than the number of segments, the saved
+ * tour is written to an array instead, so a move costs O(sqrt(N)) in any
+ * case, and a 'save' costs O(1).
+ *
+ * Created on October 17, 2026
+ */
+
+#ifndef TWOLEVELLIST_H
+#define TWOLEVELLIST_H
+
+#include "Util.h"
+#include <math.h>
+#include <vector>
+
+using namespace std;
+
+class TwoLevelList {
+public:
+    TwoLevelList();
+    void init(int num_cities, const int *tour);
+    void to_array(int *tour) const;
+    void flip(int a, int b, int c, int d);
+    bool between(int a, int b, int c) const;
+    long num_rebuilds() const;
+    void save();
+    void saved_tour(int *tour);
+
+    // the city after 'city' in the tour
+    inline int next(int city) const {
+        const segment_node &s = segment[node[city].parent];
+        if (s.reversed)
+            return city == s.first ? head(s.next) : node[city].prev;
+        return city == s.last ? head(s.next) : node[city].next;
+    }
+
+    // the city before 'city' in the tour
+    inline int prev(int city) const {
+        const segment_node &s = segment[node[city].parent];
+        if (s.reversed)
+            return city == s.last ? tail(s.prev) : node[city].next;
+        return city == s.first ? tail(s.prev) : node[city].prev;
+    }
+
+private:
+    // a city: links and sequence number in the order of its segment
+    struct city_node {
+        int next;
+        int prev;
+        int seq;
+        int parent;
+    };
+
+    // a segment: ends in its own order, and its place in the ring in tour
+    // order
+    struct segment_node {
+        int first;
+        int last;
+        int size;
+        int seq;
+        int next;
+        int prev;
+        int reversed;
+    };
+
+    int num_cities;
+    int num_parents;
+    int max_parent_size;
+    bool too_large; // a segment has grown past 'max_parent_size'
+    long rebuilds;
+    // one record per city, so that following a link touches one cache line
+    std::vector<city_node> node;
+    std::vector<segment_node> segment;
+    std::vector<int> buffer;
+    std::vector<int> tour_buffer;
+    // the saved tour: the current one before the moves in 'journal' (four
+    // cities per move), or 'saved' when 'saved_in_array'
+    bool journaling;
+    bool saved_in_array;
+    std::vector<int> journal;
+    std::vector<int> saved;
+
+    inline int head(int p) const {
+        return segment[p].reversed ? segment[p].last : segment[p].first;
+    }
+
+    inline int tail(int p) const {
+        return segment[p].reversed ? segment[p].first : segment[p].last;
+    }
+
+    // number of cities before 'city' in its segment, in tour order
+    inline int rank(int city) const {
+        const segment_node &s = segment[node[city].parent];
+        return s.reversed ? node[s.last].seq - node[city].seq :
+                node[city].seq - node[s.first].seq;
+    }
+
+    void flip_edges(int a, int b, int c, int d);
+    void apply_flip(int a, int b, int c, int d);
+    void write_saved(int *tour);
+    void reverse_within(int from, int to);
+    void reverse_path(int from, int to);
+    void reverse_by_rebuild(int from, int to);
+    void make_head(int city);
+    void make_tail(int city);
+    void move_to_prev_parent(int p, int count);
+    void move_to_next_parent(int p, int count);
+    void rebuild();
+};
+
+#endif /* TWOLEVELLIST_H */
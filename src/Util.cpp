@@ -12,9 +12,6 @@
 
 using namespace std;
 
-extern Random RANDOM; // random number generator
-
-
 // outputs an error msg and stops the program
 void error(string msg) {
     cout << msg << endl;
@@ -56,17 +53,24 @@ bool member(int elem, int *arr, int arr_size) {
 //
 // NOTE: the implementation differs (for efficiency reasons) depending 
 //       on whether 'k' is much smaller than 'n' or not.
-void pick_k_without_replacement(int k, long n, int *arr) {
+void pick_k_without_replacement(int k, long n, int *arr,
+        RandomStream &random) {
     assert(k <= n);
-    if (k == n)
-        makeshuffle(n, arr, n); // a random permutation
+    if (k == 2 && n > 2) {
+        // the cuts of a move: the second one from the n - 1 numbers left
+        arr[0] = random.below(n);
+        arr[1] = random.below(n - 1);
+        if (arr[1] >= arr[0])
+            arr[1]++;
+    } else if (k == n)
+        makeshuffle(n, arr, n, random); // a random permutation
     else if (k > n / 3) // cutoff point at n/3
-        makeshuffle(k, arr, n);
+        makeshuffle(k, arr, n, random);
     else {
         int elem;
         int picked = 0;
         while (picked < k) {
-            elem = RANDOM.uniform(0, n - 1); // a random number in 0..n-1
+            elem = random.below(n); // a random number in 0..n-1
             // check that elem is not already picked
             if (!member(elem, arr, picked)) {
                 arr[picked] = elem;
@@ -79,7 +83,7 @@ void pick_k_without_replacement(int k, long n, int *arr) {
 // on return, the first 'k' elements of 'shufflearray' will
 // be random numbers without repetition from the set: 0,1,2,...,n-1
 // the case of 'k==n' corresponds to a random permutation
-void makeshuffle(int k, int *arr, const int n) {
+void makeshuffle(int k, int *arr, const int n, RandomStream &random) {
     long i;
 
     if (k == n) {
@@ -87,7 +91,7 @@ void makeshuffle(int k, int *arr, const int n) {
         for (i = 0; i < n; i++) arr[i] = i;
         // shuffle 
         for (i = 0; i < k; i++) {
-            int other = RANDOM.uniform(i, n - 1);
+            int other = random.uniform(i, n - 1);
             int temp = arr[other];
             arr[other] = arr[i];
             arr[i] = temp;
@@ -98,7 +102,7 @@ void makeshuffle(int k, int *arr, const int n) {
         for (i = 0; i < n; i++) shufflearray[i] = i;
         // shuffle 
         for (i = 0; i < k; i++) {
-            int other = RANDOM.uniform(i, n - 1);
+            int other = random.uniform(i, n - 1);
             int temp = shufflearray[other];
             shufflearray[other] = shufflearray[i];
             shufflearray[i] = temp;
@@ -120,7 +124,7 @@ void logging(string log_file, string message) {
     logfile.close();
 }
 
-void logging(ofstream &logfile, string message) {
+void logging(ostream &logfile, string message) {
     time_t t = time(0); // get time now
     struct tm * now = localtime(& t);
     char buffer [80];
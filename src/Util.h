@@ -12,7 +12,7 @@
 #ifndef UTIL_H
 #define UTIL_H
 
-#include "Random.h"
+#include "RandomStream.h"
 #include <cassert>
 #include <fstream>
 #include <iostream>
@@ -28,6 +28,7 @@ typedef struct {
     long iteration;
     int best_tour_length;
     double list_avg;
+    long event; // index among all the records of the run, kept or not
 } lahc_results;
 
 typedef struct {
@@ -60,13 +61,14 @@ void trim_string_blanks(string &s);
 // remove all blanks (white spaces and tabs) from string 's'
 void remove_spaces(string &s);
 
-// for random function
-void makeshuffle(int k, int *shufflearray, const int n);
-void pick_k_without_replacement(int k, long n, int *arr);
+// for random function, from the stream of the run
+void makeshuffle(int k, int *shufflearray, const int n, RandomStream &random);
+void pick_k_without_replacement(int k, long n, int *arr,
+        RandomStream &random);
 
 //write in the log file
 void logging(string log_file, string message);
-void logging(ofstream &log_file, string message);
+void logging(ostream &log_file, string message);
 
 // transfer an integer number to a string with a given size
 string integer2string(long number, int num_digit);
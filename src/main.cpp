@@ -68,17 +68,117 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <sstream>
 #include "Configuration.h"
 #include "TSPLIB.h"
 #include "LAHC.h"
 #include "Util.h"
-#include "Random.h"
+#include "RandomStream.h"
 #include "Statistic.h"
 #include "pLAHC.h"
 #include "pLAHC_s.h"
+#include "Checkpoint.h"
+#include "RunPool.h"
+#include "Islands.h"
+#include <thread>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
-Random RANDOM;
+
+#define NUM_OUTPUT_FILES 5
+
+// the output files that grow run by run, cut back to their sizes at the
+// checkpoint when the experiment goes on from it
+static const char *output_files[NUM_OUTPUT_FILES] = {".log", ".progress",
+    ".events", ".bests", ".tour"};
+
+// the state of the experiment between its runs: the next run, whether it
+// is already running, and the sizes of the output files (-1 if missing)
+static void save_experiment(CheckpointOut &out, string output, int next_run,
+        bool running, unsigned long sum_iterations) {
+    out.put(next_run);
+    out.put(running);
+    out.put(sum_iterations);
+    for (int i = 0; i < NUM_OUTPUT_FILES; i++) {
+        struct stat info;
+        string file_name = output + output_files[i];
+        out.put(long(stat(file_name.c_str(), &info) == 0 ?
+                info.st_size : -1));
+    }
+}
+
+static void load_experiment(CheckpointIn &in, string output, int &next_run,
+        bool &running, unsigned long &sum_iterations) {
+    in.get(next_run);
+    in.get(running);
+    in.get(sum_iterations);
+    for (int i = 0; i < NUM_OUTPUT_FILES; i++) {
+        long size;
+        in.get(size);
+        string file_name = output + output_files[i];
+        if (size < 0)
+            remove(file_name.c_str());
+        else if (truncate(file_name.c_str(), size) != 0)
+            error("Could not restore `" + file_name + "` from the "
+                "checkpoint!");
+    }
+}
+
+// the output of a run, kept until the runs before it are written
+typedef struct {
+    ostringstream log;
+    ostringstream progress;
+    ostringstream events;
+    ostringstream bests;
+    ostringstream tour;
+    long iterations;
+} run_output;
+
+static void append_output(string file_name, ostringstream &text) {
+    if (text.tellp() > 0) {
+        ofstream file(file_name.c_str(), ios_base::app);
+        file << text.str();
+    }
+    text.str("");
+}
+
+static void write_run_output(run_output &output, ofstream &logfile,
+        string output_name) {
+    logfile << output.log.str() << flush;
+    output.log.str("");
+    append_output(output_name + ".progress", output.progress);
+    append_output(output_name + ".events", output.events);
+    append_output(output_name + ".bests", output.bests);
+    append_output(output_name + ".tour", output.tour);
+}
+
+// the results of the finished runs
+template <class T>
+static void save_runs(CheckpointOut &out, vector<T> **runs, int num_runs) {
+    for (int i = 0; i < num_runs; i++)
+        out.put_vector(*runs[i]);
+}
+
+template <class T>
+static void load_runs(CheckpointIn &in, vector<T> **runs, int num_runs) {
+    for (int i = 0; i < num_runs; i++)
+        in.get_vector(*runs[i]);
+}
+
+// the reports of a run of LAHC, or of an island-model LAHC
+template <class Run>
+static void report_lahc_run(Run &run, run_output &output, int i,
+        Configuration &config) {
+    logging(output.log, run.report_best_result());
+    if (config.restore_progress == "on")
+        run.report_progress(output.progress, integer2string(i + 1, 3));
+    if (config.restore_best_results == "on")
+        run.report_best_results(output.bests, integer2string(i + 1, 3));
+    if (config.restore_best_tour == "on")
+        run.report_best_tour(output.tour, integer2string(i + 1, 3));
+    output.iterations = run.num_iterations();
+}
 
 int main(int argc, char** argv) {
     // process command line
@@ -91,11 +191,26 @@ int main(int argc, char** argv) {
 
     Configuration config(argv[1]);
 
+    // go on from the checkpoint, if asked and there is one; how the runs
+    // are done and checkpointed does not change their results
+    Checkpoint checkpoint(config.output + ".ckpt", config.checkpoint_seconds,
+            Checkpoint::fingerprint_of(config.dump_parameters(false)));
+    CheckpointIn resumed_state;
+    bool resuming = config.resume == "on" &&
+            checkpoint.resume(resumed_state);
+    int first_run = 0;
+    bool run_started = false; // the first run goes on from the checkpoint
+    unsigned long sum_iterations = 0;
+    if (resuming)
+        load_experiment(resumed_state, config.output, first_run,
+            run_started, sum_iterations);
+
     // set the log file
-    ofstream logfile((config.output + ".log").c_str(), ios_base::out);
+    ofstream logfile((config.output + ".log").c_str(),
+            resuming ? ios_base::app : ios_base::out);
 
     // set the progress file
-    if (config.restore_progress == "on") {
+    if (config.restore_progress == "on" && !resuming) {
         ofstream progress((config.output + ".progress").c_str(),
                 ios_base::out);
         if (config.algorithm == "LAHC" || config.algorithm == "seedexplahc")
@@ -109,7 +224,7 @@ int main(int argc, char** argv) {
     }
 
     // set the special events file
-    if (config.restore_special_events == "on" &&
+    if (config.restore_special_events == "on" && !resuming &&
             (config.algorithm == "pLAHC" ||
             config.algorithm == "seedexplahc")) {
         ofstream events((config.output + ".events").c_str(),
@@ -121,7 +236,7 @@ int main(int argc, char** argv) {
     }
 
     // set the best results file
-    if (config.restore_best_results == "on") {
+    if (config.restore_best_results == "on" && !resuming) {
         ofstream bests((config.output + ".bests").c_str(),
                 ios_base::out);
         if (config.algorithm == "lahc" || config.algorithm == "seedexplahc")
@@ -132,19 +247,91 @@ int main(int argc, char** argv) {
         bests.close();
     }
 
-    // dump parameters in the log file
-    logging(logfile, config.dump_parameters());
+    // set the best tour file
+    if (config.restore_best_tour == "on" && !resuming) {
+        ofstream tours((config.output + ".tour").c_str(), ios_base::out);
+        tours << "# run best_length, then the cities of the best tour (ids "
+                "of " << config.problem_name << ")" << endl;
+        tours.close();
+    }
 
-    // Set up the random number seed using the configuration value
-    RANDOM.randomize(double(1. / config.seed));
+    // dump parameters in the log file
+    if (resuming)
+        logging(logfile, "Resuming from `" + config.output + ".ckpt` at run " +
+                std::to_string(first_run + 1));
+    else
+        logging(logfile, config.dump_parameters());
+    if (config.checkpoint_seconds > 0)
+        logging(logfile, "Checkpoints every " +
+                std::to_string(config.checkpoint_seconds) + " seconds in `" +
+                config.output + ".ckpt`");
 
     // read the given TSP instance file.
     logging(logfile, "Start reading the given `TSP` instance -- " +
             config.problem_name);
-    TSPLIB tsp_instance(config.problem_name);
+    TSPLIB tsp_instance(config.problem_name, config.distance_backend,
+            config.distance_cache_mb, config.renumbering);
+    if (config.renumbering != "none")
+        logging(logfile, "Cities are renumbered along a Hilbert curve");
+    if (tsp_instance.content_hash != 0) {
+        std::ostringstream hash;
+        hash << std::hex << std::setw(16) << std::setfill('0') <<
+                tsp_instance.content_hash;
+        logging(logfile, "Mapped the preprocessed instance, content hash " +
+                hash.str());
+    }
+    logging(logfile, "Distance matrix: " +
+            tsp_instance.distance_matrix.describe());
+    if (config.mutation.proposal == NEIGHBOUR_PROPOSAL) {
+        tsp_instance.neighbour_lists(config.mutation.num_neighbours);
+        logging(logfile, "Candidate lists of the " +
+                std::to_string(config.mutation.num_neighbours) +
+                " nearest neighbours are computed");
+    }
+
+    // the runs, the raced lists of pLAHC and the islands only read the
+    // instance, except for the tile cache of the `cache` distance backend
+    bool one_thread = tsp_instance.distance_matrix.is_cache() &&
+            (config.threads != 1 || config.race_threads != 1 ||
+            config.island.islands > 1);
+    if (one_thread) {
+        string reason = "The distance cache is not shared between threads";
+        if (config.island.islands > 1)
+            error(reason + ", so it does not take `islands` above 1!");
+        logging(logfile, reason + ", so everything is done on one thread");
+    }
+    int cores = RunPool::allowed_cores();
+    int threads = config.threads > 0 ? config.threads : cores;
+    threads = one_thread ? 1 :
+            std::max(1, std::min(threads, config.num_run - first_run));
+    // with both on one per core, the cores are shared out among the runs
+    int race_threads = config.race_threads > 0 ? config.race_threads :
+            config.threads > 0 ? cores : std::max(1, cores / threads);
+    if (one_thread)
+        race_threads = 1;
+    // a pinned run keeps its raced lists or islands on cores of its own
+    int run_cores = std::max(race_threads, config.island.islands);
+    if (threads > 1)
+        logging(logfile, "The runs are done on " + std::to_string(threads) +
+                " threads" + (config.pin_threads == "on" ?
+                ", each pinned to " + std::to_string(run_cores) + " core(s)" :
+                ""));
+    RunPool pool(threads, config.pin_threads == "on", run_cores);
+    if (config.island.islands > 1)
+        logging(logfile, "Every run of LAHC is " +
+                std::to_string(config.island.islands) + " islands on as many "
+                "threads");
+    if (race_threads > 1)
+        logging(logfile, "The lists of pLAHC are raced on " +
+                std::to_string(race_threads) + " threads");
+    if (config.threads == 0 && config.race_threads == 0 && !one_thread)
+        logging(logfile, "threads and race_threads are both 0, so the " +
+                std::to_string(cores) + " cores are shared out: " +
+                std::to_string(threads) + " runs at once, each racing its "
+                "lists on " + std::to_string(race_threads) + " threads");
+    vector<run_output> outputs(config.num_run);
 
     // run the application
-    unsigned long sum_iterations = 0;
     if (config.algorithm == "LAHC") {
         // to collect results
         vector<lahc_results> sum_results; // to calculate the avg of several runs
@@ -153,23 +340,53 @@ int main(int argc, char** argv) {
         for (int i = 0; i < config.num_run; i++)
             collective_results[i] = new vector<lahc_results>;
 
-        logging(logfile, "Start LAHC ...");
+        if (resuming)
+            load_runs(resumed_state, collective_results, first_run);
+        else
+            logging(logfile, "Start LAHC ...");
         cout << "Start LAHC ..." << endl;
-        for (int i = 0; i < config.num_run; i++) {
-            logging(logfile, "Starting Run " + integer2string(i + 1, 3));
-            LAHC lahc(tsp_instance, config.stopping, config.list_size);
+        pool.run(first_run, config.num_run, [&](int i) {
+            run_output &output = outputs[i];
+            logging(output.log, "Starting Run " + integer2string(i + 1, 3));
+            if (config.island.islands > 1) {
+                Islands islands(tsp_instance, config.stopping,
+                        config.mutation, config.progress, config.list_size,
+                        config.island, RandomStream::derive(config.seed, i));
+                islands.run();
+                report_lahc_run(islands, output, i, config);
+                islands.copy_results(collective_results, i);
+                return;
+            }
+            LAHC lahc(tsp_instance, config.stopping, config.mutation,
+                    config.progress, config.list_size,
+                    RandomStream::derive(config.seed, i));
+            if (run_started && i == first_run)
+                lahc.load_state(resumed_state);
+            if (checkpoint.enabled()) {
+                lahc.set_checkpoint(&checkpoint);
+                checkpoint.set_state([&, i](CheckpointOut &out) {
+                    save_experiment(out, config.output, i, true,
+                        sum_iterations);
+                    save_runs(out, collective_results, i);
+                    lahc.save_state(out);
+                });
+            }
             lahc.run();
-            logging(logfile, lahc.report_best_result());
-            if (config.restore_progress == "on")
-                lahc.report_progress(config.output + ".progress",
-                    integer2string(i + 1, 3));
-            if (config.restore_best_results == "on")
-                lahc.report_best_results(config.output + ".bests",
-                    integer2string(i + 1, 3));
-
+            report_lahc_run(lahc, output, i, config);
             lahc.copy_results(collective_results, i);
-            sum_iterations += lahc.num_iterations();
-        }
+        }, [&](int i) {
+            write_run_output(outputs[i], logfile, config.output);
+            sum_iterations += outputs[i].iterations;
+            if (checkpoint.enabled()) {
+                checkpoint.set_state([&, i](CheckpointOut &out) {
+                    save_experiment(out, config.output, i + 1, false,
+                        sum_iterations);
+                    save_runs(out, collective_results, i + 1);
+                });
+                if (checkpoint.due())
+                    checkpoint.write();
+            }
+        });
         // report the average of runs into the log file
         lahc_runs_avg(collective_results, sum_results, 1000, config.num_run);
         string msg = "";
@@ -210,28 +427,63 @@ int main(int argc, char** argv) {
         for (int i = 0; i < config.num_run; i++)
             collective_special_events[i] =
                 new vector<explahc_special_events>;
-        logging(logfile, "Start pLAHC ...");
+        if (resuming) {
+            load_runs(resumed_state, collective_results, first_run);
+            load_runs(resumed_state, collective_special_events, first_run);
+        } else
+            logging(logfile, "Start pLAHC ...");
         cout << "Start pLAHC for inputfile `" << config.inputfile <<
                 "` ..." << endl;
-        for (int i = 0; i < config.num_run; i++) {
-            logging(logfile, "Starting Run " + integer2string(i + 1, 3));
+        pool.run(first_run, config.num_run, [&](int i) {
+            run_output &output = outputs[i];
+            logging(output.log, "Starting Run " + integer2string(i + 1, 3));
             pLAHC explahc(tsp_instance, config.stopping,
-                    config.base_list_size, config.list_scaling_size);
+                    config.mutation, config.progress, config.base_list_size,
+                    config.list_scaling_size,
+                    RandomStream::derive(config.seed, i));
+            explahc.set_race_threads(race_threads);
+            if (run_started && i == first_run)
+                explahc.load_state(resumed_state);
+            if (checkpoint.enabled()) {
+                explahc.set_checkpoint(&checkpoint);
+                checkpoint.set_state([&, i](CheckpointOut &out) {
+                    save_experiment(out, config.output, i, true,
+                        sum_iterations);
+                    save_runs(out, collective_results, i);
+                    save_runs(out, collective_special_events, i);
+                    explahc.save_state(out);
+                });
+            }
             explahc.run();
-            logging(logfile, explahc.report_best_result());
+            logging(output.log, explahc.report_best_result());
             if (config.restore_progress == "on")
-                explahc.report_progress(config.output + ".progress",
+                explahc.report_progress(output.progress,
                     integer2string(i + 1, 3));
             if (config.restore_special_events == "on")
-                explahc.report_special_events(config.output + ".events",
+                explahc.report_special_events(output.events,
                     integer2string(i + 1, 3));
             if (config.restore_best_results == "on")
-                explahc.report_best_results(config.output + ".bests",
+                explahc.report_best_results(output.bests,
+                    integer2string(i + 1, 3));
+            if (config.restore_best_tour == "on")
+                explahc.report_best_tour(output.tour,
                     integer2string(i + 1, 3));
             // collect results of a single run
             explahc.copy_special_events(collective_special_events, i);
             explahc.copy_results(collective_results, i);
-        }
+        }, [&](int i) {
+            write_run_output(outputs[i], logfile, config.output);
+            if (checkpoint.enabled()) {
+                checkpoint.set_state([&, i](CheckpointOut &out) {
+                    save_experiment(out, config.output, i + 1, false,
+                        sum_iterations);
+                    save_runs(out, collective_results, i + 1);
+                    save_runs(out, collective_special_events, i + 1);
+                });
+                if (checkpoint.due())
+                    checkpoint.write();
+            }
+        });
 
         logging(logfile, report_explahc_result_summary(
                 collective_special_events, config.num_run));
@@ -259,28 +511,62 @@ int main(int argc, char** argv) {
         for (int i = 0; i < config.num_run; i++)
             collective_special_events[i] =
                 new vector<explahc_special_events>;
-        logging(logfile, "Start pLAHC-s ...");
+        if (resuming) {
+            load_runs(resumed_state, collective_results, first_run);
+            load_runs(resumed_state, collective_special_events, first_run);
+        } else
+            logging(logfile, "Start pLAHC-s ...");
         cout << "Start pLAHC-s for inputfile `" <<
                 config.inputfile << "` ..." << endl;
-        for (int i = 0; i < config.num_run; i++) {
-            logging(logfile, "Starting Run " + integer2string(i + 1, 3));
+        pool.run(first_run, config.num_run, [&](int i) {
+            run_output &output = outputs[i];
+            logging(output.log, "Starting Run " + integer2string(i + 1, 3));
             pLAHC_s seedexplahc(tsp_instance, config.stopping,
-                    config.base_list_size, config.list_scaling_size);
+                    config.mutation, config.progress, config.base_list_size,
+                    config.list_scaling_size, config.history_capacity,
+                    RandomStream::derive(config.seed, i));
+            if (run_started && i == first_run)
+                seedexplahc.load_state(resumed_state);
+            if (checkpoint.enabled()) {
+                seedexplahc.set_checkpoint(&checkpoint);
+                checkpoint.set_state([&, i](CheckpointOut &out) {
+                    save_experiment(out, config.output, i, true,
+                        sum_iterations);
+                    save_runs(out, collective_results, i);
+                    save_runs(out, collective_special_events, i);
+                    seedexplahc.save_state(out);
+                });
+            }
             seedexplahc.run();
-            logging(logfile, seedexplahc.report_best_result());
+            logging(output.log, seedexplahc.report_best_result());
             if (config.restore_progress == "on")
-                seedexplahc.report_progress(config.output + ".progress",
+                seedexplahc.report_progress(output.progress,
                     integer2string(i + 1, 3));
             if (config.restore_special_events == "on")
-                seedexplahc.report_special_events(config.output + ".events",
+                seedexplahc.report_special_events(output.events,
                     integer2string(i + 1, 3));
             if (config.restore_best_results == "on")
-                seedexplahc.report_best_results(config.output + ".bests",
+                seedexplahc.report_best_results(output.bests,
+                    integer2string(i + 1, 3));
+            if (config.restore_best_tour == "on")
+                seedexplahc.report_best_tour(output.tour,
                     integer2string(i + 1, 3));
             // collect results of a single run
             seedexplahc.copy_special_events(collective_special_events, i);
             seedexplahc.copy_results(collective_results, i);
-        }
+        }, [&](int i) {
+            write_run_output(outputs[i], logfile, config.output);
+            if (checkpoint.enabled()) {
+                checkpoint.set_state([&, i](CheckpointOut &out) {
+                    save_experiment(out, config.output, i + 1, false,
+                        sum_iterations);
+                    save_runs(out, collective_results, i + 1);
+                    save_runs(out, collective_special_events, i + 1);
+                });
+                if (checkpoint.due())
+                    checkpoint.write();
+            }
+        });
 
         logging(logfile, report_explahc_result_summary(
                 collective_special_events, config.num_run));
@@ -296,6 +582,16 @@ int main(int argc, char** argv) {
         }
         delete [] collective_special_events;
     }
+    if (tsp_instance.distance_matrix.is_cache()) {
+        long hits = tsp_instance.distance_matrix.cache_hits();
+        long misses = tsp_instance.distance_matrix.cache_misses();
+        logging(logfile, "Distance cache: " + std::to_string(hits) +
+                " hits, " + std::to_string(misses) + " misses, hit rate " +
+                std::to_string(100. * hits / std::max(1L, hits + misses)) +
+                "%");
+    }
+    // the experiment is over, and its checkpoint is not needed anymore
+    checkpoint.finish();
     // close the log file
     logfile.close();
     return 0;
@@ -8,20 +8,28 @@
  *
  */
 #include "pLAHC.h"
+#include <algorithm>
+#include <climits>
+#include <thread>
 
 using namespace std;
 
-extern Random RANDOM; // random number generator
-
 pLAHC::pLAHC(TSPLIB& tsp, stopping_criteria stop_criteria,
-        int base_lsize, int list_ssize) {
+        mutation_settings mutation, progress_settings progress,
+        int base_lsize, int list_ssize,
+        uint64_t seed) {
     stp_criteria = stop_criteria;
+    mut_settings = mutation;
+    prog_settings = progress;
+    stream_seed = seed;
     base_list_size = base_lsize;
     list_scaling_size = list_ssize;
     tsp_instance = &tsp;
     current_index = 0;
     total_iteration = 0;
     total_effective_iteration = 0;
+    checkpoint = NULL;
+    race_threads = 1;
     initial_new_list(base_list_size);
     best_ever_tour_length = race_track[0]->best_tour_size();
     best_ever_tour_index = 0;
@@ -39,28 +47,119 @@ pLAHC::~pLAHC() {
 }
 
 void pLAHC::run() {
+    if (race_threads > 1) {
+        run_race();
+        return;
+    }
     //    push_improvement();
-    while (stop()) {
+    while (true) {
         race_track[current_index]->run();
-        total_iteration += race_track[current_index]->num_iterations();
-        total_effective_iteration += race_track[current_index]->results.size();
-        // update special events
-        update_special_even();
-        // update the best tour info
-        if (race_track[current_index]->best_tour_size() <
-                best_ever_tour_length) {
-            best_ever_tour_length = race_track[current_index]->best_tour_size();
-            best_ever_tour_index = current_index;
-        }
-        // active the next running individual
+        finish_list(current_index);
+        if (!stop())
+            break;
+        // active the next running individual, while its size fits in an int
+        double lsize = base_list_size * pow(list_scaling_size,
+                current_index + 1);
+        if (lsize > INT_MAX)
+            break;
         current_index++;
-        initial_new_list(base_list_size * pow(list_scaling_size, current_index));
+        initial_new_list(int(lsize));
+    }
+}
+
+void pLAHC::set_race_threads(int threads) {
+    race_threads = threads;
+}
+
+void pLAHC::run_race() {
+    Race race(stp_criteria);
+    std::mutex lock; // of everything but the running lists
+    int next_list = 0; // the first one is made by the constructor
+    // the best ever tour is that of a list that is over
+    best_ever_tour_length = INT_MAX;
+    best_ever_tour_index = -1;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < race_threads; i++)
+        threads.push_back(std::thread(&pLAHC::race_lists, this,
+                std::ref(race), std::ref(lock), std::ref(next_list)));
+    for (int i = 0; i < race_threads; i++)
+        threads[i].join();
+    current_index = race_track.size() - 1;
+}
+
+void pLAHC::race_lists(Race &race, std::mutex &lock, int &next_list) {
+    while (true) {
+        int index;
+        LAHC *list;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            // no more lists once the race is over, or their size does not
+            // fit in an int
+            double lsize = base_list_size * pow(list_scaling_size, next_list);
+            if (race.is_over() || lsize > INT_MAX)
+                return;
+            index = next_list++;
+            if (index > 0) {
+                initial_new_list(int(lsize));
+                special_events[index].starting_iteration =
+                        race.total_iterations();
+            }
+            list = race_track[index];
+            list->set_race(&race);
+        }
+        list->run();
+        std::lock_guard<std::mutex> guard(lock);
+        finish_list(index);
+        special_events[index].ending_iteration = race.total_iterations();
     }
-    special_events.pop_back();
+}
+
+void pLAHC::set_checkpoint(Checkpoint *given_checkpoint) {
+    checkpoint = given_checkpoint;
+    race_track[current_index]->set_checkpoint(checkpoint);
+}
+
+void pLAHC::save_state(CheckpointOut &out) const {
+    out.put(current_index);
+    out.put(total_iteration);
+    out.put(total_effective_iteration);
+    out.put(best_ever_tour_length);
+    out.put(best_ever_tour_index);
+    out.put_vector(special_events);
+    out.put((uint64_t) race_track.size());
+    for (size_t i = 0; i < race_track.size(); i++)
+        race_track[i]->save_state(out);
+}
+
+void pLAHC::load_state(CheckpointIn &in) {
+    in.get(current_index);
+    in.get(total_iteration);
+    in.get(total_effective_iteration);
+    in.get(best_ever_tour_length);
+    in.get(best_ever_tour_index);
+    in.get_vector(special_events);
+    uint64_t num_lists;
+    in.get(num_lists);
+    for (size_t i = 0; i < race_track.size(); i++)
+        delete race_track[i];
+    race_track.clear();
+    // the lists are made again with their own size and stream from the
+    // checkpoint
+    for (uint64_t i = 0; i < num_lists; i++) {
+        race_track.push_back(new LAHC(*tsp_instance, stp_criteria,
+                mut_settings, prog_settings, 1, 0));
+        race_track.back()->load_state(in);
+    }
+    race_track[current_index]->set_checkpoint(checkpoint);
 }
 
 void pLAHC::initial_new_list(int lsize) {
-    race_track.push_back(new LAHC(*tsp_instance, stp_criteria, lsize));
+    stopping_criteria criteria = stp_criteria;
+    if (criteria.max_iteration) // what is left of the budget
+        criteria.max_iteration_par -= total_iteration;
+    uint64_t seed = RandomStream::derive(stream_seed, race_track.size());
+    race_track.push_back(new LAHC(*tsp_instance, criteria,
+            mut_settings, prog_settings, lsize, seed));
     initial_special_event.lsize = lsize;
     initial_special_event.starting_iteration = total_iteration;
     initial_special_event.ending_iteration = -1;
@@ -69,25 +168,47 @@ void pLAHC::initial_new_list(int lsize) {
     initial_special_event.best_tour_length = -1;
     initial_special_event.last_list_avg = -1.;
     special_events.push_back(initial_special_event);
+    race_track.back()->set_checkpoint(checkpoint);
 }
 
-void pLAHC::update_special_even() {
-    special_events[current_index].ending_iteration = total_iteration;
-    special_events[current_index].num_iteration =
-            race_track[current_index]->num_iterations();
-    special_events[current_index].num_effective_iteration =
-            race_track[current_index]->results.size();
-    special_events[current_index].best_tour_length =
-            race_track[current_index]->best_tour_size();
-    special_events[current_index].last_list_avg =
-            race_track[current_index]->list_average();
+void pLAHC::finish_list(int index) {
+    total_iteration += race_track[index]->num_iterations();
+    total_effective_iteration += race_track[index]->num_records();
+    update_special_even(index);
+    if (race_track[index]->best_tour_size() < best_ever_tour_length) {
+        // the former best list does not need its best tour anymore
+        if (best_ever_tour_index >= 0 && best_ever_tour_index != index)
+            race_track[best_ever_tour_index]->release(false);
+        best_ever_tour_length = race_track[index]->best_tour_size();
+        best_ever_tour_index = index;
+    }
+    // only the reports read the finished list from now on
+    race_track[index]->release(index == best_ever_tour_index);
+}
+
+void pLAHC::update_special_even(int index) {
+    special_events[index].ending_iteration = total_iteration;
+    special_events[index].num_iteration =
+            race_track[index]->num_iterations();
+    special_events[index].num_effective_iteration =
+            race_track[index]->num_records();
+    special_events[index].best_tour_length =
+            race_track[index]->best_tour_size();
+    special_events[index].last_list_avg =
+            race_track[index]->list_average();
 }
 
 bool pLAHC::stop() {
     if (total_iteration == 0)
         return true;
+    // 'max_iteration' is the budget of all lists together
+    if (stp_criteria.max_iteration &&
+            total_iteration >= stp_criteria.max_iteration_par)
+        return false;
     if (stp_criteria.solution_quality)
         return best_ever_tour_length > stp_criteria.solution_quality_par;
+    if (stp_criteria.max_iteration)
+        return true;
     error("The `stopping_criterion` is not implemented --> pLAHC::stop()");
     return false;
 }
@@ -106,6 +227,9 @@ string pLAHC::report_best_result() {
             race_track[best_ever_tour_index]->num_iterations()) + "\n";
     msg += std::string(21, ' ') + ">> total effective iterations:   ";
     msg += std::to_string(number_total_imrovements()) + "\n";
+    msg += std::string(21, ' ') + ">> acceptance rate:              ";
+    msg += std::to_string(number_total_accepted() /
+            (double) std::max(total_iteration, 1L)) + "\n";
     msg += std::string(21, ' ') + ">> list sizes:                   ";
     msg += vector2string(activated_lsizes(), ",") + "\n";
     msg += std::string(21, ' ') + ">> lists bests:                  ";
@@ -116,6 +240,21 @@ string pLAHC::report_best_result() {
     msg += vector2string(lsizes_number_iteration(), ",") + "\n";
     msg += std::string(21, ' ') + ">> lists avgs.:                  ";
     msg += vector2string(lsizes_avgs(), ",") + "\n";
+    if (prog_settings.recorder == RESERVOIR_RECORDER) {
+        int tolerance = 0;
+        for (int i = 0; i < race_track.size(); i++)
+            tolerance = std::max(tolerance,
+                    race_track[i]->progress_tolerance());
+        msg += std::string(21, ' ') + ">> progress tolerance:           ";
+        msg += std::to_string(tolerance) + "\n";
+    }
+    if (mut_settings.policy != FIXED_POLICY) {
+        // the operators over all the lists
+        OperatorSelector operators;
+        for (int i = 0; i < race_track.size(); i++)
+            operators.add(race_track[i]->operator_selector());
+        msg += operators.report();
+    }
     msg += std::string(21, ' ') + "--------------------------------------";
     return msg;
 }
@@ -162,48 +301,87 @@ inline long pLAHC::number_total_imrovements() {
     return total_improves;
 }
 
+inline long pLAHC::number_total_accepted() {
+    long total_accepted = 0;
+    for (int i = 0; i < race_track.size(); i++)
+        total_accepted += race_track[i]->num_accepted();
+    return total_accepted;
+}
+
 long pLAHC::num_iterations() {
     return total_iteration;
 }
 
-void pLAHC::report_progress(string prog_file, string run_num) {
-    // it will store the progress in a file with name <output>.progress
-    ofstream progress(prog_file.c_str(), ios_base::app);
-    progress << "## Run number " << run_num << endl;
+int pLAHC::best_tour_size() {
+    return best_ever_tour_length;
+}
+
+std::vector<pLAHC::list_record> pLAHC::ordered_records() {
+    // the lists are one after another, unless they were raced, and a stable
+    // sort keeps the records of a list and of a tie in the order of the lists
+    std::vector<list_record> records;
     long effective_iter = 0;
-    long total_iter = 1;
+    for (int l = 0; l < race_track.size(); l++) {
+        for (long j = 0; j < race_track[l]->results.size(); j++)
+            records.push_back({l, j, effective_iter +
+                    race_track[l]->results[j].event + 1});
+        effective_iter += race_track[l]->num_records();
+    }
+    if (race_threads == 1)
+        return records;
+    std::stable_sort(records.begin(), records.end(),
+            [this](const list_record &a, const list_record &b) {
+                return special_events[a.list].starting_iteration +
+                        race_track[a.list]->results[a.record].iteration <
+                        special_events[b.list].starting_iteration +
+                        race_track[b.list]->results[b.record].iteration;
+            });
+    // the improvements of all the lists up to each record, as far as the
+    // records of the other lists tell
+    std::vector<long> counted(race_track.size(), 0);
+    effective_iter = 0;
+    for (long i = 0; i < records.size(); i++) {
+        long events = race_track[records[i].list]->
+                results[records[i].record].event + 1;
+        effective_iter += events - counted[records[i].list];
+        counted[records[i].list] = events;
+        records[i].effective_iteration = effective_iter;
+    }
+    return records;
+}
+
+void pLAHC::report_progress(ostream &progress, string run_num) {
+    // it will write the progress for the file with name <output>.progress
+    progress << "## Run number " << run_num << endl;
     int best_so_far = race_track[0]->results[0].best_tour_length;
     int best_so_far_lsize = special_events[0].lsize;
-    for (int lsize_index = 0; lsize_index < race_track.size(); lsize_index++) {
-        for (long l_indicator = 0; l_indicator <
-                race_track[lsize_index]->results.size(); l_indicator++) {
-            if (best_so_far > race_track[lsize_index]->results[l_indicator].best_tour_length) {
-                best_so_far = race_track[lsize_index]->results[l_indicator].best_tour_length;
-                best_so_far_lsize = special_events[lsize_index].lsize;
-            }
-            progress << "(" << std::to_string(total_iter +
-                    race_track[lsize_index]->results[l_indicator].iteration) <<
-                    ", " << std::to_string(++effective_iter) << ", " <<
-                    std::to_string(best_so_far) << ", " <<
-                    std::to_string(best_so_far_lsize) << ", " <<
-                    std::to_string(special_events[lsize_index].lsize) << ", " <<
-                    std::to_string(race_track[lsize_index]->
-                    results[l_indicator].best_tour_length) << ", " <<
-                    std::to_string(race_track[lsize_index]->
-                    results[l_indicator].iteration + 1) << ", " <<
-                    std::to_string(l_indicator + 1) << ", " <<
-                    std::to_string(race_track[lsize_index]->
-                    results[l_indicator].list_avg) << ")";
+    std::vector<list_record> records = ordered_records();
+    for (long i = 0; i < records.size(); i++) {
+        int lsize_index = records[i].list;
+        const lahc_results &record =
+                race_track[lsize_index]->results[records[i].record];
+        // the iterations of all the lists when this one started, as in the
+        // special events, so that raced lists are on the same axis
+        long total_iter = special_events[lsize_index].starting_iteration + 1;
+        if (best_so_far > record.best_tour_length) {
+            best_so_far = record.best_tour_length;
+            best_so_far_lsize = special_events[lsize_index].lsize;
         }
-        total_iter += special_events[lsize_index].num_iteration;
+        progress << "(" << std::to_string(total_iter + record.iteration) <<
+                ", " << std::to_string(records[i].effective_iteration) <<
+                ", " << std::to_string(best_so_far) << ", " <<
+                std::to_string(best_so_far_lsize) << ", " <<
+                std::to_string(special_events[lsize_index].lsize) << ", " <<
+                std::to_string(record.best_tour_length) << ", " <<
+                std::to_string(record.iteration + 1) << ", " <<
+                std::to_string(record.event + 1) << ", " <<
+                std::to_string(record.list_avg) << ")";
     }
     progress << endl;
-    progress.close();
 }
 
-void pLAHC::report_special_events(string events_file, string run_num) {
-    // it will store the special events in a file with name <output>.events
-    ofstream events(events_file.c_str(), ios_base::app);
+void pLAHC::report_special_events(ostream &events, string run_num) {
+    // it will write the special events for the file with name <output>.events
     events << "## Run number " << run_num << endl;
     for (long i = 0; i < special_events.size(); i++)
         events << "(" << std::to_string(special_events[i].lsize) << ", " <<
@@ -213,12 +391,10 @@ void pLAHC::report_special_events(string events_file, string run_num) {
         std::to_string(special_events[i].num_effective_iteration) << ", " <<
         std::to_string(special_events[i].best_tour_length) << ", " <<
         std::to_string(special_events[i].last_list_avg) << ")" << endl;
-    events.close();
 }
 
-void pLAHC::report_best_results(string best_results_file, string run_num) {
-    // it will store best results obtained in each run in a file 
-    ofstream bests(best_results_file.c_str(), ios_base::app);
+void pLAHC::report_best_results(ostream &bests, string run_num) {
+    // it will write the best results of the run for the file <output>.bests
     bests << run_num << " " << std::to_string(total_iteration) << " " <<
             std::to_string(best_ever_tour_length) << " " << std::to_string(
             int(base_list_size * pow(list_scaling_size,
@@ -226,7 +402,10 @@ void pLAHC::report_best_results(string best_results_file, string run_num) {
             race_track[best_ever_tour_index]->num_iterations())
             << " " << std::to_string(race_track[best_ever_tour_index]->
             list_average()) << endl;
-    bests.close();
+}
+
+void pLAHC::report_best_tour(ostream &tours, string run_num) {
+    race_track[best_ever_tour_index]->report_best_tour(tours, run_num);
 }
 
 void pLAHC::copy_special_events(vector<explahc_special_events>
@@ -237,27 +416,27 @@ void pLAHC::copy_special_events(vector<explahc_special_events>
 
 void pLAHC::copy_results(vector<explahc_results>
         **collective_results, int run) {
-    long total_effect_iter = 0;
     int best_tour_length = race_track[0]->results[0].best_tour_length;
     int best_tour_lsize = special_events[0].lsize;
     double best_tour_list_avg = race_track[0]->results[0].list_avg;
-    for (int l_ind = 0; l_ind < special_events.size(); l_ind++)
-        for (long j = 0; j < race_track[l_ind]->results.size(); j++) {
-            if (race_track[l_ind]->results[j].best_tour_length <=
-                    best_tour_length) {
-                best_tour_length =
-                        race_track[l_ind]->results[j].best_tour_length;
-                best_tour_lsize = special_events[l_ind].lsize;
-                best_tour_list_avg = race_track[l_ind]->results[j].list_avg;
-            }
-            collective_results[run]->push_back({
-                special_events[l_ind].starting_iteration +
-                race_track[l_ind]->results[j].iteration,
-                race_track[l_ind]->results[j].best_tour_length,
-                special_events[l_ind].lsize,
-                race_track[l_ind]->results[j].list_avg,
-                ++total_effect_iter, best_tour_length, best_tour_lsize,
-                best_tour_list_avg
-            });
+    // in the order of the iterations, which Statistic expects
+    std::vector<list_record> records = ordered_records();
+    for (long i = 0; i < records.size(); i++) {
+        int l_ind = records[i].list;
+        const lahc_results &record =
+                race_track[l_ind]->results[records[i].record];
+        if (record.best_tour_length <= best_tour_length) {
+            best_tour_length = record.best_tour_length;
+            best_tour_lsize = special_events[l_ind].lsize;
+            best_tour_list_avg = record.list_avg;
         }
+        collective_results[run]->push_back({
+            special_events[l_ind].starting_iteration + record.iteration,
+            record.best_tour_length,
+            special_events[l_ind].lsize,
+            record.list_avg,
+            records[i].effective_iteration,
+            best_tour_length, best_tour_lsize, best_tour_list_avg
+        });
+    }
 }
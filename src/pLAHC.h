@@ -5,6 +5,18 @@
  * 
  * Description: This is an implementation of Parameter-less Late Acceptance 
  * Hill-Climbing (pLAHC) algorithm (the work is published in GECCO'17).
+ * With 'set_race_threads' (`race_threads`), 'run' races the lists on that
+ * many threads: each thread runs the next list size once its list is
+ * over, until a list reaches the `solution_quality` or the lists used the
+ * `max_iteration` budget together (see Race.h; Configuration asks for one
+ * of the two), and the running lists are then stopped. The race_track and
+ * the special events stay in the order of the list sizes;
+ * 'starting_iteration' and 'ending_iteration' of a list are the iterations
+ * of all the lists when it was started and when it was over; the progress
+ * records are in the order of those iterations, and the effective
+ * iterations count the improvements the lists recorded up to each of them.
+ * Which list gets how far depends on the threads, so a race is not
+ * repeatable.
  *
  * Created on April 28, 2016, 11:13 PM
  */
@@ -16,12 +28,13 @@
 #include "TSPLIB.h"
 #include "Util.h"
 #include "Configuration.h"
-#include "Random.h"
+#include "RandomStream.h"
 #include <iostream>
 #include <vector>
 #include <stdlib.h> 
 #include <fstream>
 #include <math.h>
+#include <mutex>
 
 
 using namespace std;
@@ -31,15 +44,23 @@ public:
     std::vector <LAHC*> race_track;
     std::vector <explahc_special_events> special_events;
     pLAHC(TSPLIB &tsp, stopping_criteria stop_criterion,
-            int base_lsize, int list_ssize);
+            mutation_settings mutation, progress_settings progress,
+            int base_lsize, int list_ssize,
+            uint64_t seed);
     ~pLAHC();
     void run();
+    void set_checkpoint(Checkpoint *checkpoint);
+    void set_race_threads(int threads);
+    void save_state(CheckpointOut &out) const;
+    void load_state(CheckpointIn &in);
     string report_best_result();
-    void report_progress(string prog_file, string run_num);
-    void report_special_events(string events_file, string run_num);
-    void report_best_results(string best_results_file, string run_num);
+    void report_progress(ostream &progress, string run_num);
+    void report_special_events(ostream &events, string run_num);
+    void report_best_results(ostream &bests, string run_num);
+    void report_best_tour(ostream &tours, string run_num);
     string report_avg_runs();
     long num_iterations();
+    int best_tour_size();
     void copy_special_events(vector<explahc_special_events>
             **collective_special_events, int run);
     void copy_results(vector<explahc_results>
@@ -47,6 +68,9 @@ public:
 private:
     TSPLIB *tsp_instance;
     stopping_criteria stp_criteria;
+    mutation_settings mut_settings;
+    progress_settings prog_settings;
+    uint64_t stream_seed; // list i runs on the sub-stream i of it
     int base_list_size;
     int list_scaling_size;
     int current_index;
@@ -55,12 +79,27 @@ private:
     explahc_special_events initial_special_event;
     int best_ever_tour_length;
     int best_ever_tour_index;
+    Checkpoint *checkpoint; // of the running list, NULL for none
+    int race_threads; // lists run at once
+
+    typedef struct {
+        int list; // in race_track
+        long record; // in its results
+        long effective_iteration; // of all the lists
+    } list_record;
 
     bool stop();
     void initial_new_list(int lsize);
-    void update_special_even();
+    void update_special_even(int index);
+    // the totals, special events and best list once list 'index' is over
+    void finish_list(int index);
+    void run_race();
+    void race_lists(Race &race, std::mutex &lock, int &next_list);
+    // the records of all the lists, in the order of their iterations
+    std::vector<list_record> ordered_records();
 
     inline long number_total_imrovements();
+    inline long number_total_accepted();
     inline std::vector<int> activated_lsizes();
     inline std::vector<int> best_tours_lsizes();
     inline std::vector<long> lsizes_number_iteration();
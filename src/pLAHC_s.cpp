@@ -10,20 +10,26 @@
  */
 
 #include "pLAHC_s.h"
+#include <climits>
 
 using namespace std;
 
-extern Random RANDOM; // random number generator
-
 pLAHC_s::pLAHC_s(TSPLIB& tsp, stopping_criteria stop_criteria,
-        int base_lsize, int list_ssize) {
+        mutation_settings mutation, progress_settings progress,
+        int base_lsize, int list_ssize, int capacity, uint64_t seed) {
     stp_criteria = stop_criteria;
+    mut_settings = mutation;
+    prog_settings = progress;
+    stream_seed = seed;
     base_list_size = base_lsize;
     list_scaling_size = list_ssize;
     tsp_instance = &tsp;
+    history_capacity = capacity;
+    history.init(history_capacity);
     current_index = 0;
     total_iteration = 0;
     total_effective_iteration = 0;
+    checkpoint = NULL;
     initial_new_list(base_list_size);
     best_ever_tour_length = race_track[0]->best_tour_size();
     best_ever_tour_index = 0;
@@ -35,9 +41,7 @@ pLAHC_s::~pLAHC_s() {
     race_track.resize(0);
     race_track.clear();
     race_track.shrink_to_fit();
-    history.resize(0);
     history.clear();
-    history.shrink_to_fit();
     special_events.resize(0);
     special_events.clear();
     special_events.shrink_to_fit();
@@ -45,33 +49,92 @@ pLAHC_s::~pLAHC_s() {
 
 void pLAHC_s::run() {
     //    push_improvement();
-    while (stop()) {
+    while (true) {
         race_track[current_index]->run();
         total_iteration += race_track[current_index]->num_iterations();
-        total_effective_iteration += race_track[current_index]->results.size();
+        total_effective_iteration += race_track[current_index]->num_records();
         // update special events
         update_special_even();
         // update the best tour info
         if (race_track[current_index]->best_tour_size() <
                 best_ever_tour_length) {
+            // the former best list does not need its best tour anymore
+            if (best_ever_tour_index != current_index)
+                race_track[best_ever_tour_index]->release(false);
             best_ever_tour_length = race_track[current_index]->best_tour_size();
             best_ever_tour_index = current_index;
         }
         // rectify the objective function values history
         rectify_history();
-        // active the next running individual
+        // only the reports read the finished list from now on
+        race_track[current_index]->release(
+                current_index == best_ever_tour_index);
+        if (!stop())
+            break;
+        // active the next running individual, while its size fits in an int
+        double lsize = base_list_size * pow(list_scaling_size,
+                current_index + 1);
+        if (lsize > INT_MAX)
+            break;
         current_index++;
-        initial_new_list(base_list_size * pow(list_scaling_size, current_index));
+        initial_new_list(int(lsize));
+    }
+}
+
+void pLAHC_s::set_checkpoint(Checkpoint *given_checkpoint) {
+    checkpoint = given_checkpoint;
+    race_track[current_index]->set_checkpoint(checkpoint);
+}
+
+void pLAHC_s::save_state(CheckpointOut &out) const {
+    out.put(current_index);
+    out.put(total_iteration);
+    out.put(total_effective_iteration);
+    out.put(best_ever_tour_length);
+    out.put(best_ever_tour_index);
+    history.save(out);
+    out.put_vector(special_events);
+    out.put((uint64_t) race_track.size());
+    for (size_t i = 0; i < race_track.size(); i++)
+        race_track[i]->save_state(out);
+}
+
+void pLAHC_s::load_state(CheckpointIn &in) {
+    in.get(current_index);
+    in.get(total_iteration);
+    in.get(total_effective_iteration);
+    in.get(best_ever_tour_length);
+    in.get(best_ever_tour_index);
+    history.load(in);
+    in.get_vector(special_events);
+    uint64_t num_lists;
+    in.get(num_lists);
+    for (size_t i = 0; i < race_track.size(); i++)
+        delete race_track[i];
+    race_track.clear();
+    // the lists are made again with their own size and stream from the
+    // checkpoint
+    for (uint64_t i = 0; i < num_lists; i++) {
+        race_track.push_back(new LAHC(*tsp_instance, stp_criteria,
+                mut_settings, prog_settings, 1, 0));
+        race_track.back()->load_state(in);
     }
-    special_events.pop_back();
+    race_track[current_index]->set_checkpoint(checkpoint);
 }
 
 void pLAHC_s::initial_new_list(int lsize) {
-    if (history.size() == 0)
-        race_track.push_back(new LAHC(*tsp_instance, stp_criteria, lsize));
+    stopping_criteria criteria = stp_criteria;
+    if (criteria.max_iteration) // what is left of the budget
+        criteria.max_iteration_par -= total_iteration;
+    uint64_t seed = RandomStream::derive(stream_seed, race_track.size());
+    if (history.empty())
+        race_track.push_back(new LAHC(*tsp_instance, criteria,
+            mut_settings, prog_settings, lsize, seed));
     else
-        race_track.push_back(new LAHC(*tsp_instance, stp_criteria, lsize,
+        race_track.push_back(new LAHC(*tsp_instance, criteria,
+            mut_settings, prog_settings, lsize, seed,
             race_track[best_ever_tour_index]->best_ever_tour(), history));
+    race_track.back()->keep_improvements(history_capacity);
     initial_special_event.lsize = lsize;
     initial_special_event.starting_iteration = total_iteration;
     initial_special_event.ending_iteration = -1;
@@ -80,6 +143,7 @@ void pLAHC_s::initial_new_list(int lsize) {
     initial_special_event.best_tour_length = -1;
     initial_special_event.last_list_avg = -1.;
     special_events.push_back(initial_special_event);
+    race_track.back()->set_checkpoint(checkpoint);
 }
 
 void pLAHC_s::update_special_even() {
@@ -87,7 +151,7 @@ void pLAHC_s::update_special_even() {
     special_events[current_index].num_iteration =
             race_track[current_index]->num_iterations();
     special_events[current_index].num_effective_iteration =
-            race_track[current_index]->results.size();
+            race_track[current_index]->num_records();
     special_events[current_index].best_tour_length =
             race_track[current_index]->best_tour_size();
     special_events[current_index].last_list_avg =
@@ -97,18 +161,22 @@ void pLAHC_s::update_special_even() {
 inline bool pLAHC_s::stop() {
     if (total_iteration == 0)
         return true;
+    // 'max_iteration' is the budget of all lists together
+    if (stp_criteria.max_iteration &&
+            total_iteration >= stp_criteria.max_iteration_par)
+        return false;
     if (stp_criteria.solution_quality)
         return best_ever_tour_length > stp_criteria.solution_quality_par;
+    if (stp_criteria.max_iteration)
+        return true;
     error("The `stopping_criterion` is not implemented --> pLAHC_s::stop()");
     return false;
 }
 
 void pLAHC_s::rectify_history() {
-    for (int i = 0; i < race_track[current_index]->
-            success_iteration_tour_length.size(); i++)
-        history.push_back(race_track[current_index]->
-            success_iteration_tour_length[i]);
-    sort(history.begin(), history.end());
+    // the improvements of a list are kept in order, and are merged in
+    // without sorting the history again
+    history.add_history(race_track[current_index]->improvement_history());
 }
 
 string pLAHC_s::report_best_result() {
@@ -125,6 +193,9 @@ string pLAHC_s::report_best_result() {
             race_track[best_ever_tour_index]->num_iterations()) + "\n";
     msg += std::string(21, ' ') + ">> total effective iterations:   ";
     msg += std::to_string(number_total_imrovements()) + "\n";
+    msg += std::string(21, ' ') + ">> acceptance rate:              ";
+    msg += std::to_string(number_total_accepted() /
+            (double) std::max(total_iteration, 1L)) + "\n";
     msg += std::string(21, ' ') + ">> list sizes:                   ";
     msg += vector2string(activated_lsizes(), ",") + "\n";
     msg += std::string(21, ' ') + ">> lists bests:                  ";
@@ -135,6 +206,21 @@ string pLAHC_s::report_best_result() {
     msg += vector2string(lsizes_number_iteration(), ",") + "\n";
     msg += std::string(21, ' ') + ">> lists avgs.:                  ";
     msg += vector2string(lsizes_avgs(), ",") + "\n";
+    if (prog_settings.recorder == RESERVOIR_RECORDER) {
+        int tolerance = 0;
+        for (int i = 0; i < race_track.size(); i++)
+            tolerance = std::max(tolerance,
+                    race_track[i]->progress_tolerance());
+        msg += std::string(21, ' ') + ">> progress tolerance:           ";
+        msg += std::to_string(tolerance) + "\n";
+    }
+    if (mut_settings.policy != FIXED_POLICY) {
+        // the operators over all the lists
+        OperatorSelector operators;
+        for (int i = 0; i < race_track.size(); i++)
+            operators.add(race_track[i]->operator_selector());
+        msg += operators.report();
+    }
     msg += std::string(21, ' ') + "--------------------------------------";
     return msg;
 }
@@ -181,13 +267,19 @@ inline long pLAHC_s::number_total_imrovements() {
     return total_improves;
 }
 
+inline long pLAHC_s::number_total_accepted() {
+    long total_accepted = 0;
+    for (int i = 0; i < race_track.size(); i++)
+        total_accepted += race_track[i]->num_accepted();
+    return total_accepted;
+}
+
 long pLAHC_s::num_iterations() {
     return total_iteration;
 }
 
-void pLAHC_s::report_progress(string prog_file, string run_num) {
-    // it will store the progress in a file with name <output>.progress
-    ofstream progress(prog_file.c_str(), ios_base::app);
+void pLAHC_s::report_progress(ostream &progress, string run_num) {
+    // it will write the progress for the file with name <output>.progress
     progress << "## Run number " << run_num << endl;
     long effective_iter = 0;
     long total_iter = 1;
@@ -204,7 +296,8 @@ void pLAHC_s::report_progress(string prog_file, string run_num) {
             }
             progress << "(" << std::to_string(total_iter +
                     race_track[lsize_index]->results[l_indicator].iteration) <<
-                    ", " << std::to_string(++effective_iter) << ", " <<
+                    ", " << std::to_string(effective_iter +
+                    race_track[lsize_index]->results[l_indicator].event + 1) << ", " <<
                     std::to_string(best_so_far) << ", " <<
                     std::to_string(best_so_far_lsize) << ", " <<
                     std::to_string(special_events[lsize_index].lsize) << ", " <<
@@ -212,19 +305,19 @@ void pLAHC_s::report_progress(string prog_file, string run_num) {
                     results[l_indicator].best_tour_length) << ", " <<
                     std::to_string(race_track[lsize_index]->
                     results[l_indicator].iteration + 1) << ", " <<
-                    std::to_string(l_indicator + 1) << ", " <<
+                    std::to_string(race_track[lsize_index]->
+                    results[l_indicator].event + 1) << ", " <<
                     std::to_string(race_track[lsize_index]->
                     results[l_indicator].list_avg) << ")";
         }
         total_iter += special_events[lsize_index].num_iteration;
+        effective_iter += race_track[lsize_index]->num_records();
     }
     progress << endl;
-    progress.close();
 }
 
-void pLAHC_s::report_special_events(string events_file, string run_num) {
-    // it will store the special events in a file with name <output>.events
-    ofstream events(events_file.c_str(), ios_base::app);
+void pLAHC_s::report_special_events(ostream &events, string run_num) {
+    // it will write the special events for the file with name <output>.events
     events << "## Run number " << run_num << endl;
     for (long i = 0; i < special_events.size(); i++)
         events << "(" << std::to_string(special_events[i].lsize) << ", " <<
@@ -234,12 +327,10 @@ void pLAHC_s::report_special_events(string events_file, string run_num) {
         std::to_string(special_events[i].num_effective_iteration) << ", " <<
         std::to_string(special_events[i].best_tour_length) << ", " <<
         std::to_string(special_events[i].last_list_avg) << ")" << endl;
-    events.close();
 }
 
-void pLAHC_s::report_best_results(string best_results_file, string run_num) {
-    // it will store best results obtained in each run in a file 
-    ofstream bests(best_results_file.c_str(), ios_base::app);
+void pLAHC_s::report_best_results(ostream &bests, string run_num) {
+    // it will write the best results of the run for the file <output>.bests
     bests << run_num << " " << std::to_string(total_iteration) << " " <<
             std::to_string(best_ever_tour_length) << " " << std::to_string(
             int(base_list_size * pow(list_scaling_size,
@@ -247,7 +338,10 @@ void pLAHC_s::report_best_results(string best_results_file, string run_num) {
             race_track[best_ever_tour_index]->num_iterations())
             << " " << std::to_string(race_track[best_ever_tour_index]->
             list_average()) << endl;
-    bests.close();
+}
+
+void pLAHC_s::report_best_tour(ostream &tours, string run_num) {
+    race_track[best_ever_tour_index]->report_best_tour(tours, run_num);
 }
 
 void pLAHC_s::copy_special_events(vector<explahc_special_events>
@@ -262,7 +356,7 @@ void pLAHC_s::copy_results(vector<explahc_results>
     int best_tour_length = race_track[0]->results[0].best_tour_length;
     int best_tour_lsize = special_events[0].lsize;
     double best_tour_list_avg = race_track[0]->results[0].list_avg;
-    for (int l_ind = 0; l_ind < special_events.size(); l_ind++)
+    for (int l_ind = 0; l_ind < special_events.size(); l_ind++) {
         for (long j = 0; j < race_track[l_ind]->results.size(); j++) {
             if (race_track[l_ind]->results[j].best_tour_length <=
                     best_tour_length) {
@@ -277,8 +371,10 @@ void pLAHC_s::copy_results(vector<explahc_results>
                 race_track[l_ind]->results[j].best_tour_length,
                 special_events[l_ind].lsize,
                 race_track[l_ind]->results[j].list_avg,
-                ++total_effect_iter, best_tour_length, best_tour_lsize,
-                best_tour_list_avg
+                total_effect_iter + race_track[l_ind]->results[j].event + 1,
+                best_tour_length, best_tour_lsize, best_tour_list_avg
             });
         }
+        total_effect_iter += race_track[l_ind]->num_records();
+    }
 }
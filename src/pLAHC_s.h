@@ -14,10 +14,11 @@
 #define PLAHC_S_H
 
 #include "LAHC.h"
+#include "SeedHistory.h"
 #include "TSPLIB.h"
 #include "Util.h"
 #include "Configuration.h"
-#include "Random.h"
+#include "RandomStream.h"
 #include <iostream>
 #include <vector>
 #include <stdlib.h> 
@@ -32,13 +33,19 @@ public:
     std::vector <LAHC*> race_track;
     std::vector <explahc_special_events> special_events;
     pLAHC_s(TSPLIB &tsp, stopping_criteria stop_criterion,
-            int base_lsize, int list_ssize);
+            mutation_settings mutation, progress_settings progress,
+            int base_lsize, int list_ssize, int history_capacity,
+            uint64_t seed);
     ~pLAHC_s();
     void run();
+    void set_checkpoint(Checkpoint *checkpoint);
+    void save_state(CheckpointOut &out) const;
+    void load_state(CheckpointIn &in);
     string report_best_result();
-    void report_progress(string prog_file, string run_num);
-    void report_special_events(string events_file, string run_num);
-    void report_best_results(string best_results_file, string run_num);
+    void report_progress(ostream &progress, string run_num);
+    void report_special_events(ostream &events, string run_num);
+    void report_best_results(ostream &bests, string run_num);
+    void report_best_tour(ostream &tours, string run_num);
     string report_avg_runs();
     long num_iterations();
     void copy_special_events(vector<explahc_special_events>
@@ -47,8 +54,12 @@ public:
             **collective_results, int run);
 private:
     TSPLIB *tsp_instance;
-    std::vector<int> history;
+    SeedHistory history; // the improvements of the former lists
+    int history_capacity; // of 'history' and of that of every list
     stopping_criteria stp_criteria;
+    mutation_settings mut_settings;
+    progress_settings prog_settings;
+    uint64_t stream_seed; // list i runs on the sub-stream i of it
     int base_list_size;
     int list_scaling_size;
     int current_index;
@@ -57,12 +68,14 @@ private:
     explahc_special_events initial_special_event;
     int best_ever_tour_length;
     int best_ever_tour_index;
+    Checkpoint *checkpoint; // of the running list, NULL for none
 
     inline bool stop();
     void initial_new_list(int lsize);
     void update_special_even();
     void rectify_history();
     inline long number_total_imrovements();
+    inline long number_total_accepted();
     inline std::vector<int> activated_lsizes();
     inline std::vector<int> best_tours_lsizes();
     inline std::vector<long> lsizes_number_iteration();
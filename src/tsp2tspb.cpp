@@ -0,0 +1,89 @@
+/*
+ * File:    tsp2tspb.cpp
+ * Author:  Mosab Bazargani
+ * License: BSD 3-Clause License
+ *
+ * Description: Converts a TSPLIB instance into the preprocessed binary
+ * format (.tspb), which pLAHC maps instead of parsing the instance and
+ * computing the distance matrix at every start. Usage:
+ *      tsp2tspb instance.tsp [instance.tspb] [num_neighbours] [backend]
+ *          'num_neighbours' nearest neighbour lists are stored if it is
+ *          greater than 0 (default 0); 'backend' is the distance_backend
+ *          used to decide if the matrix is stored (default auto).
+ *      tsp2tspb --verify instance.tspb
+ *          checks the hash of all sections of a .tspb file.
+ *
+ * Created on October 17, 2026
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string.h>
+#include "TSPLIB.h"
+#include "TSPB.h"
+
+using namespace std;
+
+string hex_hash(uint64_t hash) {
+    std::ostringstream out;
+    out << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return out.str();
+}
+
+int verify(string tspb_file) {
+    if (!is_tspb_file(tspb_file))
+        error(tspb_file + " is not a .tspb file!");
+    tspb_header header;
+    std::ifstream in(tspb_file, ios::binary);
+    in.read((char *) &header, sizeof (header));
+    in.close();
+    TSPLIB tsp_instance(tspb_file);
+    uint64_t hash = tspb_content_hash(header, header.comment_offset ?
+            tsp_instance.properties.COMMENT.c_str() : NULL,
+            tsp_instance.cities_x, tsp_instance.cities_y,
+            header.matrix_offset ? tsp_instance.distance_matrix.rows() : NULL,
+            header.neighbours_offset ? tsp_instance.neighbours.data() : NULL);
+    if (hash != header.content_hash) {
+        cout << tspb_file << ": content hash " << hex_hash(hash)
+                << " does not match the header (" <<
+                hex_hash(header.content_hash) << ")" << endl;
+        return 1;
+    }
+    cout << tspb_file << ": OK, content hash " << hex_hash(hash) << endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cout << "Usage: " << argv[0] << " instance.tsp [instance.tspb] "
+                "[num_neighbours] [distance_backend]" << endl;
+        cout << "       " << argv[0] << " --verify instance.tspb" << endl;
+        exit(1);
+    }
+    if (strcmp(argv[1], "--verify") == 0) {
+        if (argc < 3)
+            error("--verify needs a .tspb file!");
+        return verify(argv[2]);
+    }
+
+    string tsp_file = argv[1];
+    string tspb_file;
+    if (argc > 2)
+        tspb_file = argv[2];
+    else {
+        size_t dot = tsp_file.find_last_of('.');
+        tspb_file = (dot == string::npos ? tsp_file : tsp_file.substr(0, dot))
+                + ".tspb";
+    }
+    int num_neighbours = (argc > 3) ? atoi(argv[3]) : 0;
+    string backend = (argc > 4) ? argv[4] : "auto";
+
+    TSPLIB tsp_instance(tsp_file, backend);
+    tsp_instance.write_tspb(tspb_file, num_neighbours);
+    cout << tspb_file << ": " << tsp_instance.properties.DIMENSION
+            << " cities, distance matrix: "
+            << tsp_instance.distance_matrix.describe() << endl;
+    return 0;
+}